@@ -0,0 +1,59 @@
+#version 330 core
+// Bloom downsample: 13 taps around the destination texel, weighted as five
+// overlapping 2x2 boxes (Jimenez, "Next Generation Post Processing in CoD:AW")
+out vec3 FragColor;
+in vec2 uv;
+
+uniform sampler2D srcTexture;
+uniform int karisAverage;   // 1 on the first level: tames single-pixel fireflies
+
+float luma(vec3 c) {
+    return dot(c, vec3(0.2126, 0.7152, 0.0722));
+}
+
+vec3 karis(vec3 a, vec3 b, vec3 c, vec3 d) {
+    float wa = 1.0 / (1.0 + luma(a));
+    float wb = 1.0 / (1.0 + luma(b));
+    float wc = 1.0 / (1.0 + luma(c));
+    float wd = 1.0 / (1.0 + luma(d));
+    return (a * wa + b * wb + c * wc + d * wd) / (wa + wb + wc + wd);
+}
+
+void main() {
+    vec2 t = 1.0 / vec2(textureSize(srcTexture, 0));
+
+    // a - b - c
+    // - j - k -
+    // d - e - f
+    // - l - m -
+    // g - h - i
+    vec3 a = texture(srcTexture, uv + t * vec2(-2.0,  2.0)).rgb;
+    vec3 b = texture(srcTexture, uv + t * vec2( 0.0,  2.0)).rgb;
+    vec3 c = texture(srcTexture, uv + t * vec2( 2.0,  2.0)).rgb;
+    vec3 d = texture(srcTexture, uv + t * vec2(-2.0,  0.0)).rgb;
+    vec3 e = texture(srcTexture, uv).rgb;
+    vec3 f = texture(srcTexture, uv + t * vec2( 2.0,  0.0)).rgb;
+    vec3 g = texture(srcTexture, uv + t * vec2(-2.0, -2.0)).rgb;
+    vec3 h = texture(srcTexture, uv + t * vec2( 0.0, -2.0)).rgb;
+    vec3 i = texture(srcTexture, uv + t * vec2( 2.0, -2.0)).rgb;
+    vec3 j = texture(srcTexture, uv + t * vec2(-1.0,  1.0)).rgb;
+    vec3 k = texture(srcTexture, uv + t * vec2( 1.0,  1.0)).rgb;
+    vec3 l = texture(srcTexture, uv + t * vec2(-1.0, -1.0)).rgb;
+    vec3 m = texture(srcTexture, uv + t * vec2( 1.0, -1.0)).rgb;
+
+    vec3 result;
+    if (karisAverage == 1) {
+        // each box luma-weighted on its own, then the usual box weights
+        result  = karis(j, k, l, m) * 0.5;
+        result += karis(a, b, d, e) * 0.125;
+        result += karis(b, c, e, f) * 0.125;
+        result += karis(d, e, g, h) * 0.125;
+        result += karis(e, f, h, i) * 0.125;
+    } else {
+        result  = e * 0.125;
+        result += (a + c + g + i) * 0.03125;
+        result += (b + d + f + h) * 0.0625;
+        result += (j + k + l + m) * 0.125;
+    }
+    FragColor = max(result, vec3(0.0001));
+}
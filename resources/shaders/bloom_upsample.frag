@@ -0,0 +1,31 @@
+#version 330 core
+// Bloom upsample: 3x3 tent filter over the smaller level; the result is
+// blended additively onto the larger one (glBlendFunc(GL_ONE, GL_ONE))
+out vec3 FragColor;
+in vec2 uv;
+
+uniform sampler2D srcTexture;
+uniform float filterRadius;   // in uv units
+
+void main() {
+    float x = filterRadius;
+    float y = filterRadius * float(textureSize(srcTexture, 0).x) / float(textureSize(srcTexture, 0).y);
+
+    vec3 a = texture(srcTexture, vec2(uv.x - x, uv.y + y)).rgb;
+    vec3 b = texture(srcTexture, vec2(uv.x,     uv.y + y)).rgb;
+    vec3 c = texture(srcTexture, vec2(uv.x + x, uv.y + y)).rgb;
+    vec3 d = texture(srcTexture, vec2(uv.x - x, uv.y)).rgb;
+    vec3 e = texture(srcTexture, vec2(uv.x,     uv.y)).rgb;
+    vec3 f = texture(srcTexture, vec2(uv.x + x, uv.y)).rgb;
+    vec3 g = texture(srcTexture, vec2(uv.x - x, uv.y - y)).rgb;
+    vec3 h = texture(srcTexture, vec2(uv.x,     uv.y - y)).rgb;
+    vec3 i = texture(srcTexture, vec2(uv.x + x, uv.y - y)).rgb;
+
+    // 1 2 1
+    // 2 4 2  / 16
+    // 1 2 1
+    vec3 result = e * 4.0;
+    result += (b + d + f + h) * 2.0;
+    result += (a + c + g + i);
+    FragColor = result * (1.0 / 16.0);
+}
@@ -1,57 +0,0 @@
-#version 330 core
-out vec4 FragColor;
-in vec2 uv;
-
-uniform sampler2D image;
-uniform bool horizontal;
-
-// 5-tap Gaussian weights
-uniform float weight[5] = float[] (0.227027, 0.1945946, 0.1216216, 0.054054, 0.016216);
-
-void main() {
-    vec2 tex_offset = 1.0 / textureSize(image, 0); // gets size of single texel
-    vec3 result = texture(image, uv).rgb * weight[0];
-
-    if(horizontal) {
-        for(int i = 1; i < 5; ++i) {
-            result += texture(image, uv + vec2(tex_offset.x * i, 0.0)).rgb * weight[i];
-            result += texture(image, uv - vec2(tex_offset.x * i, 0.0)).rgb * weight[i];
-        }
-    } else {
-        for(int i = 1; i < 5; ++i) {
-            result += texture(image, uv + vec2(0.0, tex_offset.y * i)).rgb * weight[i];
-            result += texture(image, uv - vec2(0.0, tex_offset.y * i)).rgb * weight[i];
-        }
-    }
-    FragColor = vec4(result, 1.0);
-}
-
-
-
-// #version 330 core
-// out vec4 FragColor;
-// in vec2 uv;
-
-// uniform sampler2D image;
-// uniform bool horizontal; // Horizontal vs Vertical pass
-
-// // Gaussian weights (simple 5-tap, can be expanded to 9 or more for bigger glow)
-// uniform float weight[5] = float[] (0.227027, 0.1945946, 0.1216216, 0.054054, 0.016216);
-
-// void main() {
-//     vec2 tex_offset = 1.0 / textureSize(image, 0); // gets size of single texel
-//     vec3 result = texture(image, uv).rgb * weight[0]; // current fragment's contribution
-    
-//     if(horizontal) {
-//         for(int i = 1; i < 5; ++i) {
-//             result += texture(image, uv + vec2(tex_offset.x * i, 0.0)).rgb * weight[i];
-//             result += texture(image, uv - vec2(tex_offset.x * i, 0.0)).rgb * weight[i];
-//         }
-//     } else {
-//         for(int i = 1; i < 5; ++i) {
-//             result += texture(image, uv + vec2(0.0, tex_offset.y * i)).rgb * weight[i];
-//             result += texture(image, uv - vec2(0.0, tex_offset.y * i)).rgb * weight[i];
-//         }
-//     }
-//     FragColor = vec4(result, 1.0);
-// }
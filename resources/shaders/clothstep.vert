@@ -0,0 +1,119 @@
+#version 410 core
+// one GpuCloth pass per particle, captured by transform feedback. A substep
+// is ClothSolver::stepView() cut into its passes: predict (and move the
+// pins), one pass per constraint colour, then collision and velocities.
+// Within a colour a particle is in at most one constraint, so each vertex
+// applies its own side of it and the result is the CPU's Gauss-Seidel sweep.
+// 'precise' (hence 4.10) keeps the compiler from fusing multiply-adds, so
+// every operation rounds as the CPU's does and the two stay bit for bit
+// equal; the cloth is chaotic enough that one ulp grows into a visible gap
+
+const int MAX_PINS = 16;   // GpuCloth::MAX_PINS
+
+const int PASS_PREDICT   = 0;
+const int PASS_CONSTRAIN = 1;
+const int PASS_FINISH    = 2;
+
+uniform samplerBuffer state;       // 3 texels per particle: pos, vel, start of the substep
+uniform samplerBuffer particles;   // invMass, sin(phase), cos(phase), pin (-1 = none)
+
+uniform int width;
+uniform int height;
+uniform int pass;
+
+// PASS_PREDICT
+uniform float h;
+uniform float sinT;       // sin(windFreq * t), t = end of this substep
+uniform float cosT;
+uniform vec3 gravity;
+uniform vec3 wind;        // windDir * windStrength
+uniform float pinT;       // how far the pins are from 'from' to 'to'
+uniform vec3 pinFrom[MAX_PINS];
+uniform vec3 pinTo[MAX_PINS];
+
+// PASS_CONSTRAIN: pairs (i, i + span) along rows (axis 0) or columns (1)
+// whose start has (i / span) % 2 == colour, as solveRows / solveColumns
+uniform int axis;
+uniform int span;
+uniform int colour;
+uniform float rest;
+uniform float alphaTilde; // compliance / h^2
+
+// PASS_FINISH
+uniform float invH;
+uniform float velScale;   // 1 / (h (1 + damping h))
+uniform vec3 sphereCenter;
+uniform float sphereRadius;
+uniform float floorY;
+
+out vec4 outPos;
+out vec4 outVel;
+out vec4 outStart;
+
+vec3 posAt(int i) { return texelFetch(state, 3 * i).xyz; }
+
+void main() {
+    int i = gl_VertexID;
+    ivec2 cell = ivec2(i % width, i / width);
+
+    vec4 p = texelFetch(particles, i);
+    float w = p.x;
+    precise vec3 pos = posAt(i);
+    precise vec3 vel = texelFetch(state, 3 * i + 1).xyz;
+    vec3 start = texelFetch(state, 3 * i + 2).xyz;
+
+    if (pass == PASS_PREDICT) {
+        start = pos;
+        if (p.w >= 0.0) {
+            int pin = int(p.w);
+            pos = mix(pinFrom[pin], pinTo[pin], pinT);
+        } else if (w > 0.0) {
+            float gust = sinT * p.z + cosT * p.y;
+            vel = vel + (gravity + wind * (gust * w)) * h;
+            pos = pos + vel * h;
+        }
+    } else if (pass == PASS_CONSTRAIN) {
+        int along  = axis == 0 ? cell.x : cell.y;
+        int length = axis == 0 ? width : height;
+        int step   = axis == 0 ? span : span * width;
+
+        // this particle's constraint of the colour, if any: as its start
+        // (a) or its end (b)
+        int a = -1, b = -1;
+        if (along + span < length && (along / span) % 2 == colour) {
+            a = i; b = i + step;
+        } else if (along >= span && ((along - span) / span) % 2 == colour) {
+            a = i - step; b = i;
+        }
+
+        if (a >= 0) {
+            vec3 pa = posAt(a), pb = posAt(b);
+            float wa = texelFetch(particles, a).x, wb = texelFetch(particles, b).x;
+
+            // distanceFactor() in clothgrid.cpp
+            precise vec3 d = pb - pa;
+            precise float dist  = sqrt(d.x * d.x + d.y * d.y + d.z * d.z);
+            precise float denom = (wa + wb) + alphaTilde;
+            if (denom > 0.0 && dist >= 1e-6) {
+                precise float k = (dist - rest) / (denom * dist);
+                pos = (a == i) ? pos + (wa * k) * d : pos - (wb * k) * d;
+            }
+        }
+    } else if (w > 0.0) {
+        // head sphere, floor
+        vec3 toCenter = pos - sphereCenter;
+        precise float d2 = toCenter.x * toCenter.x + toCenter.y * toCenter.y + toCenter.z * toCenter.z;
+        if (d2 < sphereRadius * sphereRadius) {
+            pos = sphereCenter + toCenter * (sphereRadius / sqrt(d2 + 1e-8));
+        }
+        if (pos.y < floorY) pos.y = floorY;
+
+        vel = (pos - start) * velScale;
+    } else if (p.w >= 0.0) {
+        vel = (pos - start) * invH;   // a pin: the anchor's velocity, undamped
+    }
+
+    outPos   = vec4(pos, 1.0);
+    outVel   = vec4(vel, 0.0);
+    outStart = vec4(start, 1.0);
+}
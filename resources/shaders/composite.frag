@@ -3,13 +3,24 @@ out vec4 FragColor;
 in vec2 uv;
 
 uniform sampler2D scene;
-uniform sampler2D bloomBlur;
-uniform float exposure; // <--- Make sure this is sent as 1.0 in C++
+uniform sampler2D bloomBlur;     // Bloom::getTexture(), half resolution
+uniform float exposure;
+uniform float bloomStrength;
+uniform int tonemap;             // 0 = pass the scene through (start screen)
 
 void main() {
     vec3 color = texture(scene, uv).rgb;
-    // Simple pass-through for start screen
-    FragColor = vec4(color, 1.0);
+    if (tonemap == 0) {
+        FragColor = vec4(color, 1.0);
+        return;
+    }
+
+    vec3 hdrColor = color + texture(bloomBlur, uv).rgb * bloomStrength;
+
+    // exposure tonemap: keeps the neon from washing out to white
+    vec3 result = vec3(1.0) - exp(-hdrColor * exposure);
+
+    FragColor = vec4(result, 1.0);
 }
 
 // #version 330 core
@@ -10,6 +10,11 @@ uniform sampler2D gNormal;
 uniform sampler2D gAlbedo;
 uniform sampler2D gEmissive;
 
+// GBuffer::LAYOUT_COMPACT: no position target, normals octahedral in RG
+uniform int compactGBuffer;
+uniform sampler2D gDepth;
+uniform mat4 invViewProj;
+
 // -------- Global coefficients (match C++ names) --------
 uniform float k_a;
 uniform float k_d;
@@ -17,19 +22,40 @@ uniform float k_s;
 
 uniform vec3 camPos;
 
-// light description (Copied from default.frag)
+// light description, std140 layout shared with LightBuffer (C++).
+// four vec4s per light, scalars packed into the w components
+#define MAX_LIGHTS 256
+
 struct Light {
-    int   type;      // 0 = point, 1 = directional, 2 = spot
-    vec3  color;
-    vec3  pos;
-    vec3  dir;
-    vec3  atten;
-    float angle;
-    float penumbra;  // outer - inner
+    vec4 posType;      // xyz = pos,   w = type (0 = point, 1 = directional, 2 = spot)
+    vec4 colorAngle;   // rgb = color, w = spot angle
+    vec4 dirPenumbra;  // xyz = dir,   w = penumbra (outer - inner)
+    vec4 atten;        // xyz = constant / linear / quadratic
 };
 
-uniform int   numLights;
-uniform Light lights[8];
+layout(std140) uniform LightBlock {
+    Light lights[MAX_LIGHTS];
+};
+
+uniform int numLights;
+
+// tiled mode (TiledLighting): all lights in a buffer texture, and a light
+// index list per TILE_SIZE x TILE_SIZE screen tile
+uniform int tiledLighting;            // 0 = loop LightBlock, 1 = per-tile lists
+uniform samplerBuffer  lightData;     // 4 texels per light, same layout as Light
+uniform usamplerBuffer tileGrid;      // per tile: first index, count
+uniform usamplerBuffer tileIndices;
+uniform int tileSize;
+uniform int numTilesX;
+
+Light fetchLight(int i) {
+    Light l;
+    l.posType     = texelFetch(lightData, i * 4);
+    l.colorAngle  = texelFetch(lightData, i * 4 + 1);
+    l.dirPenumbra = texelFetch(lightData, i * 4 + 2);
+    l.atten       = texelFetch(lightData, i * 4 + 3);
+    return l;
+}
 
 // === Fog parameters (NEW) ===
 uniform float fogStartRadius;  // where fog begins (in world XZ)
@@ -43,6 +69,21 @@ uniform vec3  fogColor;        // colour of the fog (matches clear colour-ish)
 // ----------------------------------------------------
 #define DEBUG_VIEW 0 // <-- Set to 0 for full lighting
 
+vec3 octDecode(vec2 e) {
+    e = e * 2.0 - 1.0;
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) {
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(n);
+}
+
+vec3 reconstructPosition(vec2 uv, float depth) {
+    vec4 ndc = vec4(uv * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+    vec4 world = invViewProj * ndc;
+    return world.xyz / world.w;
+}
+
 // distanceFalloff (Copied from default.frag)
 float distanceFalloff(vec3 coeffs, float d) {
     float a = coeffs.x;
@@ -70,6 +111,16 @@ float spotFalloff(float angleToAxis, float angle, float penumbra) {
 
 // Light contribution function (Adapted from default.frag)
 vec3 lightContrib(Light light, vec3 wsPosition, vec3 wsNormal, vec3 camPos, vec3 albedoColor) {
+    // unpack
+    int   type     = int(light.posType.w);
+    vec3  pos      = light.posType.xyz;
+    vec3  color    = light.colorAngle.rgb;
+    float angle    = light.colorAngle.w;
+    vec3  dir      = light.dirPenumbra.xyz;
+    float penumbra = light.dirPenumbra.w;
+    vec3  atten    = light.atten.xyz;
+    float range    = light.atten.w;
+
     float shininess = 32.0; // Placeholder shininess
     vec3 cSpecular = vec3(1.0); // Placeholder white specular color
 
@@ -80,20 +131,26 @@ vec3 lightContrib(Light light, vec3 wsPosition, vec3 wsNormal, vec3 camPos, vec3
     float d = 0.0;
     float attenuation = 1.0;
 
-    if (light.type == 0 || light.type == 2) { // Point or Spot
-        L = light.pos - wsPosition;
+    if (type == 0 || type == 2) { // Point or Spot
+        L = pos - wsPosition;
         d = length(L);
         L = normalize(L);
 
-        attenuation = distanceFalloff(light.atten, d);
+        attenuation = distanceFalloff(atten, d);
 
-        if (light.type == 2) { // Spot
-            float angleToAxis = acos(dot(-L, normalize(light.dir)));
-            attenuation *= spotFalloff(angleToAxis, light.angle, light.penumbra);
+        // fade to exactly zero at the range the tiles were culled with
+        if (d >= range) return vec3(0.0);
+        float x = d / range;
+        float window = clamp(1.0 - x * x * x * x, 0.0, 1.0);
+        attenuation *= window * window;
+
+        if (type == 2) { // Spot
+            float angleToAxis = acos(dot(-L, normalize(dir)));
+            attenuation *= spotFalloff(angleToAxis, angle, penumbra);
         }
 
-    } else if (light.type == 1) { // Directional
-        L = normalize(light.dir);
+    } else if (type == 1) { // Directional
+        L = normalize(dir);
         attenuation = 1.0; // No falloff for directional
     }
 
@@ -105,7 +162,7 @@ vec3 lightContrib(Light light, vec3 wsPosition, vec3 wsNormal, vec3 camPos, vec3
     }
 
     // diffuse
-    vec3 diffuse  = k_d * albedoColor * NdotL * light.color;
+    vec3 diffuse  = k_d * albedoColor * NdotL * color;
 
     // specular
     vec3 specular = vec3(0.0);
@@ -113,7 +170,7 @@ vec3 lightContrib(Light light, vec3 wsPosition, vec3 wsNormal, vec3 camPos, vec3
         vec3 R      = reflect(-L, N);
         float RdotV = max(dot(R, V), 0.0);
         float sTerm = pow(RdotV, shininess);
-        specular    = k_s * cSpecular * sTerm * light.color;
+        specular    = k_s * cSpecular * sTerm * color;
     }
 
     // each light will return its local phong contribution in RGB
@@ -123,11 +180,25 @@ vec3 lightContrib(Light light, vec3 wsPosition, vec3 wsNormal, vec3 camPos, vec3
 
 void main() {
     // Read data from the G-Buffer textures
-    vec3 position  = texture(gPosition, uv).rgb;
-    vec3 normal    = texture(gNormal, uv).rgb;
+    vec3 position;
+    vec3 normal;
     vec4 albedo    = texture(gAlbedo, uv);
     vec3 emissive  = texture(gEmissive, uv).rgb;
 
+    if (compactGBuffer == 1) {
+        float depth = texture(gDepth, uv).r;
+        if (depth >= 1.0) {
+            // nothing drawn here; the full layout shades the cleared zeros the same way
+            fragColor = vec4(emissive, 1.0);
+            return;
+        }
+        position = reconstructPosition(uv, depth);
+        normal   = octDecode(texture(gNormal, uv).rg);
+    } else {
+        position = texture(gPosition, uv).rgb;
+        normal   = texture(gNormal, uv).rgb;
+    }
+
     vec3 debug_color = vec3(0.0);
 
 #if DEBUG_VIEW == 1
@@ -152,9 +223,18 @@ void main() {
     vec3 final_color = k_a * albedoColor;
 
     // Lights
-    int count = min(numLights, 8);
-    for (int i = 0; i < count; ++i) {
-        final_color += lightContrib(lights[i], position, normal, camPos, albedoColor);
+    if (tiledLighting == 1) {
+        ivec2 tile = ivec2(gl_FragCoord.xy) / tileSize;
+        uvec2 list = texelFetch(tileGrid, tile.y * numTilesX + tile.x).rg;
+        for (uint k = 0u; k < list.y; ++k) {
+            int idx = int(texelFetch(tileIndices, int(list.x + k)).r);
+            final_color += lightContrib(fetchLight(idx), position, normal, camPos, albedoColor);
+        }
+    } else {
+        int count = min(numLights, MAX_LIGHTS);
+        for (int i = 0; i < count; ++i) {
+            final_color += lightContrib(lights[i], position, normal, camPos, albedoColor);
+        }
     }
 
     // Add Emissive
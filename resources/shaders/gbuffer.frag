@@ -6,9 +6,9 @@ layout(location = 3) out vec4 gEmissive;
 
 in vec3 worldPos;
 in vec3 worldNormal;
+flat in vec3 albedo;
+flat in vec3 emissive;
 
-uniform vec3 albedoColor;
-uniform vec3 emissiveColor;
 uniform int useTexture; // 0 = Color, 1 = Texture
 uniform sampler2D uTexture;
 
@@ -21,10 +21,10 @@ void main() {
        gAlbedo = texture(uTexture, vec2(worldPos.x, worldPos.z));
     } else {
        // Otherwise use the solid color passed from C++
-       gAlbedo = vec4(albedoColor, 1.0);
+       gAlbedo = vec4(albedo, 1.0);
     }
 
-    gEmissive = vec4(emissiveColor, 1.0);
+    gEmissive = vec4(emissive, 1.0);
 }
 
 // // Replace the ENTIRE content of gbuffer.frag with this
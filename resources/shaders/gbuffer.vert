@@ -7,8 +7,13 @@ uniform mat4 model;
 uniform mat4 view;
 uniform mat4 proj;
 
+uniform vec3 albedoColor;
+uniform vec3 emissiveColor;
+
 out vec3 worldPos;
 out vec3 worldNormal;
+flat out vec3 albedo;     // per draw here, per instance in gbuffer_instanced.vert
+flat out vec3 emissive;
 
 void main() {
     vec4 wp = model * vec4(inPos, 1.0);
@@ -16,5 +21,8 @@ void main() {
 
     worldNormal = normalize(mat3(transpose(inverse(model))) * inNormal);
 
+    albedo   = albedoColor;
+    emissive = emissiveColor;
+
     gl_Position = proj * view * wp;
 }
@@ -0,0 +1,44 @@
+#version 330 core
+// GpuCloth straight from its state buffers: no vertex attributes, the
+// index buffer's values are particle indices. Positions blend between the
+// state before the last step and the current one; normals are the cross of
+// the central differences, like ClothSolver::normalRows()
+
+uniform samplerBuffer state;       // 3 texels per particle: pos, vel, start
+uniform samplerBuffer prevState;
+uniform float alpha;
+uniform int width;
+uniform int height;
+
+uniform mat4 view;
+uniform mat4 proj;
+
+uniform vec3 albedoColor;
+uniform vec3 emissiveColor;
+
+out vec3 worldPos;
+out vec3 worldNormal;
+flat out vec3 albedo;
+flat out vec3 emissive;
+
+vec3 posAt(int x, int y) {
+    int i = 3 * (y * width + x);
+    return mix(texelFetch(prevState, i).xyz, texelFetch(state, i).xyz, alpha);
+}
+
+void main() {
+    int x = gl_VertexID % width;
+    int y = gl_VertexID / width;
+
+    vec3 t = posAt(min(x + 1, width - 1), y) - posAt(max(x - 1, 0), y);
+    vec3 u = posAt(x, min(y + 1, height - 1)) - posAt(x, max(y - 1, 0));
+    vec3 n = cross(t, u);
+
+    worldPos    = posAt(x, y);
+    worldNormal = dot(n, n) > 1e-12 ? normalize(n) : vec3(0.0, 1.0, 0.0);
+
+    albedo   = albedoColor;
+    emissive = emissiveColor;
+
+    gl_Position = proj * view * vec4(worldPos, 1.0);
+}
@@ -0,0 +1,35 @@
+#version 330 core
+// GBuffer::LAYOUT_COMPACT targets; world position comes from depth later
+layout(location = 0) out vec2 gNormal;     // octahedral, [0,1]
+layout(location = 1) out vec4 gAlbedo;
+layout(location = 2) out vec3 gEmissive;   // R11G11B10F
+
+in vec3 worldPos;
+in vec3 worldNormal;
+flat in vec3 albedo;
+flat in vec3 emissive;
+
+uniform int useTexture; // 0 = Color, 1 = Texture
+uniform sampler2D uTexture;
+
+// unit vector -> octahedron -> unfolded square in [-1,1]^2
+vec2 octEncode(vec3 n) {
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 e = n.xy;
+    if (n.z < 0.0) {
+        e = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return e;
+}
+
+void main() {
+    gNormal = octEncode(normalize(worldNormal)) * 0.5 + 0.5;
+
+    if (useTexture == 1) {
+       gAlbedo = texture(uTexture, vec2(worldPos.x, worldPos.z));
+    } else {
+       gAlbedo = vec4(albedo, 1.0);
+    }
+
+    gEmissive = max(emissive, vec3(0.0));
+}
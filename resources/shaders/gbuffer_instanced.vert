@@ -0,0 +1,30 @@
+#version 330 core
+
+layout(location = 0) in vec3 inPos;
+layout(location = 1) in vec3 inNormal;
+
+// per instance (PropBatch)
+layout(location = 2) in mat4 instModel;   // 2..5
+layout(location = 6) in vec3 instAlbedo;
+layout(location = 7) in vec3 instEmissive;
+layout(location = 8) in mat3 instNormalMatrix;   // 8..10
+
+uniform mat4 view;
+uniform mat4 proj;
+
+out vec3 worldPos;
+out vec3 worldNormal;
+flat out vec3 albedo;
+flat out vec3 emissive;
+
+void main() {
+    vec4 wp = instModel * vec4(inPos, 1.0);
+    worldPos = wp.xyz;
+
+    worldNormal = normalize(instNormalMatrix * inNormal);
+
+    albedo   = instAlbedo;
+    emissive = instEmissive;
+
+    gl_Position = proj * view * wp;
+}
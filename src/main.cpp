@@ -1,22 +1,113 @@
 #include "mainwindow.h"
 
+#include "offscreen.h"
+#include "settings.h"
+
 #include <QApplication>
+#include <QCommandLineParser>
 #include <QScreen>
 #include <iostream>
 #include <QSettings>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 
 int main(int argc, char *argv[]) {
+    // offscreen runs must not need a display server; the platform plugin is
+    // picked when QApplication is constructed, so look before the parser does.
+    // Qt's "offscreen" plugin only gets GL through GLX on Linux, so with no
+    // display at all go through eglfs on surfaceless EGL (Mesa) instead
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--offscreen") || !qgetenv("QT_QPA_PLATFORM").isEmpty()) continue;
+#ifdef Q_OS_LINUX
+        if (qgetenv("DISPLAY").isEmpty() && qgetenv("WAYLAND_DISPLAY").isEmpty()) {
+            qputenv("QT_QPA_PLATFORM", "eglfs");
+            if (qgetenv("QT_QPA_EGLFS_INTEGRATION").isEmpty()) qputenv("QT_QPA_EGLFS_INTEGRATION", "none");
+            if (qgetenv("EGL_PLATFORM").isEmpty()) qputenv("EGL_PLATFORM", "surfaceless");
+            continue;
+        }
+#endif
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
     QApplication a(argc, argv);
 
     QCoreApplication::setApplicationName("Project 5: Realtime");
     QCoreApplication::setOrganizationName("CS 1230");
     QCoreApplication::setApplicationVersion(QT_VERSION_STR);
 
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption recordOption("record", "Record this session's inputs to <file>.", "file");
+    parser.addOption(recordOption);
+    QCommandLineOption lightsOption("lights", "Number of bouncing lights in the arena.", "count");
+    parser.addOption(lightsOption);
+    QCommandLineOption gbufferOption("gbuffer", "G-buffer layout: full (default) or compact.", "layout");
+    parser.addOption(gbufferOption);
+    QCommandLineOption clothOption("cloth", "Boss cloth solver: cpu (default) or gpu.", "backend");
+    parser.addOption(clothOption);
+    QCommandLineOption offscreenOption("offscreen", "Render without a window (see --frames, --size, --out).");
+    parser.addOption(offscreenOption);
+    QCommandLineOption framesOption("frames", "Offscreen: number of frames to render.", "count", "300");
+    parser.addOption(framesOption);
+    QCommandLineOption sizeOption("size", "Offscreen: render size.", "WxH", "1280x720");
+    parser.addOption(sizeOption);
+    QCommandLineOption outOption("out", "Offscreen: write frames to <dir>.", "dir");
+    parser.addOption(outOption);
+    QCommandLineOption rawOption("raw", "Offscreen: one raw RGBA file instead of PNGs.");
+    parser.addOption(rawOption);
+    QCommandLineOption everyOption("every", "Offscreen: write every Nth frame.", "n", "1");
+    parser.addOption(everyOption);
+    QCommandLineOption replayOption("replay", "Offscreen: drive the session from a --record file.", "file");
+    parser.addOption(replayOption);
+    QCommandLineOption clothCheckOption("cloth-check", "Offscreen: compare the GPU cloth with the CPU reference for <steps> steps, render nothing.", "steps");
+    parser.addOption(clothCheckOption);
+    parser.process(a);
+    if (parser.isSet(recordOption)) {
+        settings.recordPath = parser.value(recordOption).toStdString();
+    }
+    if (parser.isSet(lightsOption)) {
+        settings.bouncingLights = parser.value(lightsOption).toInt();
+    }
+    if (parser.isSet(gbufferOption)) {
+        std::string layout = parser.value(gbufferOption).toStdString();
+        if (layout != "full" && layout != "compact") {
+            std::cerr << "--gbuffer expects full or compact" << std::endl;
+            return 1;
+        }
+        settings.compactGBuffer = layout == "compact";
+    }
+    if (parser.isSet(clothOption)) {
+        std::string backend = parser.value(clothOption).toStdString();
+        if (backend != "cpu" && backend != "gpu") {
+            std::cerr << "--cloth expects cpu or gpu" << std::endl;
+            return 1;
+        }
+        settings.gpuCloth = backend == "gpu";
+    }
+
     QSurfaceFormat fmt;
     fmt.setVersion(4, 1);
     fmt.setProfile(QSurfaceFormat::CoreProfile);
     QSurfaceFormat::setDefaultFormat(fmt);
 
+    if (parser.isSet(offscreenOption)) {
+        OffscreenOptions opts;
+        opts.frames = parser.value(framesOption).toInt();
+        std::string size = parser.value(sizeOption).toStdString();
+        if (std::sscanf(size.c_str(), "%dx%d", &opts.width, &opts.height) != 2 ||
+            opts.width <= 0 || opts.height <= 0) {
+            std::cerr << "--size expects WxH, e.g. 1280x720" << std::endl;
+            return 1;
+        }
+        opts.outDir = parser.value(outOption).toStdString();
+        opts.raw = parser.isSet(rawOption);
+        opts.captureEvery = std::max(1, parser.value(everyOption).toInt());
+        opts.replayPath = parser.value(replayOption).toStdString();
+        if (parser.isSet(clothCheckOption)) opts.clothCheck = std::max(1, parser.value(clothCheckOption).toInt());
+        return runOffscreen(opts);
+    }
+
     MainWindow w;
     w.initialize();
     w.resize(800, 600);
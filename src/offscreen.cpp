@@ -0,0 +1,170 @@
+#include "offscreen.h"
+
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QSurfaceFormat>
+#include <QDir>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+#include "realtime.h"
+#include "sim/batchrunner.h"
+#include "sim/inputrecording.h"
+#include "utils/framecapture.h"
+#include "utils/gpucloth.h"
+
+namespace {
+// GpuCloth and ClothGrid::step() agree to float rounding (exactly, where
+// the GPU's sqrt / divide are IEEE); anything past this (world units) over
+// one second is a real difference
+const float CLOTH_TOLERANCE = 1e-3f;
+
+// the boss cloth stepped on the GPU and by the game's CPU solver side by side,
+// the boss swinging round a loop; positions compared every second, then the
+// GPU reseeded from the CPU so a rounding difference can't grow chaotically
+int runClothCheck(int steps) {
+    // nothing is drawn, but a draw call still wants a complete framebuffer
+    GLuint fbo = 0, color = 0;
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glGenRenderbuffers(1, &color);
+    glBindRenderbuffer(GL_RENDERBUFFER, color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, 1, 1);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+
+    int result = 1;
+    {
+        GpuCloth gpu;
+        if (gpu.init(GhostCloth::W, GhostCloth::H)) {
+            std::cout << "renderer    " << glGetString(GL_RENDERER) << "\n";
+
+            glm::vec3 bossPos(-24.f, 1.f, 24.f);
+            GhostCloth ghost;
+            ghost.init(bossPos);
+            ClothGrid<GhostCloth::W, GhostCloth::H> reference = ghost.getGrid();
+            gpu.upload(reference);
+
+            const float dt = ArenaSim::FIXED_DT;
+            std::vector<glm::vec3> positions;
+            float worst = 0.f;
+            for (int s = 0; s < steps; ++s) {
+                bossPos += glm::vec3(std::cos(s * 0.01f), 0.f, std::sin(s * 0.013f)) * (9.f * dt);
+                ghost.aim(reference, bossPos);
+                ghost.aim(gpu, bossPos);
+                reference.step(dt);
+                gpu.step(dt);
+
+                if ((s + 1) % 60 != 0 && s + 1 != steps) continue;
+                gpu.readPositions(positions);
+                float error = 0.f;
+                for (int y = 0; y < GhostCloth::H; ++y) {
+                    for (int x = 0; x < GhostCloth::W; ++x) {
+                        error = std::max(error, glm::length(positions[GhostCloth::index(x, y)] - reference.getPos(x, y)));
+                    }
+                }
+                worst = std::max(worst, error);
+                std::cout << "step " << (s + 1) << "  max error " << error << "\n";
+                gpu.upload(reference);
+            }
+
+            GLenum glError = glGetError();
+            result = (worst <= CLOTH_TOLERANCE && glError == GL_NO_ERROR) ? 0 : 1;
+            std::cout << "worst       " << worst << " (tolerance " << CLOTH_TOLERANCE << ")\n";
+            if (glError != GL_NO_ERROR) std::cout << "GL error    0x" << std::hex << glError << std::dec << "\n";
+            std::cout << (result == 0 ? "cloth check OK" : "cloth check FAILED") << std::endl;
+        }
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteRenderbuffers(1, &color);
+    glDeleteFramebuffers(1, &fbo);
+    return result;
+}
+}
+
+int runOffscreen(const OffscreenOptions &opts) {
+    InputRecording recording;
+    if (!opts.replayPath.empty()) {
+        std::string error;
+        if (!recording.load(opts.replayPath, &error)) {
+            std::cerr << "offscreen: " << error << std::endl;
+            return 1;
+        }
+    }
+    const bool replaying = !opts.replayPath.empty();
+
+    // no window: a context on an offscreen surface (pbuffer or surfaceless
+    // EGL, depending on the platform plugin), everything drawn into FBOs
+    QOffscreenSurface surface;
+    surface.setFormat(QSurfaceFormat::defaultFormat());
+    surface.create();
+    QOpenGLContext context;
+    context.setFormat(QSurfaceFormat::defaultFormat());
+    if (!surface.isValid() || !context.create() || !context.makeCurrent(&surface)) {
+        std::cerr << "offscreen: could not create a GL context" << std::endl;
+        return 1;
+    }
+
+    if (opts.clothCheck > 0) {
+        glewInit();
+        int result = runClothCheck(opts.clothCheck);
+        context.doneCurrent();
+        return result;
+    }
+
+    FrameCapture capture;
+    if (!opts.outDir.empty()) {
+        QDir().mkpath(QString::fromStdString(opts.outDir));
+        if (!capture.init(opts.width, opts.height, opts.outDir,
+                          opts.raw ? FrameCapture::FORMAT_RAW : FrameCapture::FORMAT_PNG)) {
+            return 1;
+        }
+    }
+
+    int rendered = 0;
+    double seconds = 0.0;
+    {
+        Realtime realtime;
+        realtime.resize(opts.width, opts.height);
+        realtime.initializeOffscreen(opts.width, opts.height, replaying ? &recording : nullptr);
+
+        InputRecording::Cursor cursor(recording);
+        const float dt = replaying ? recording.getDt() : ArenaSim::FIXED_DT;
+
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < opts.frames; ++frame) {
+            InputFrame input;
+            bool playing = true;
+            if (replaying) {
+                if (!cursor.next(input, playing)) break;
+            } else {
+                input = BatchRunner::botInput(realtime.getSim());
+            }
+
+            realtime.renderOffscreenFrame(dt, input, playing);
+            if (!opts.outDir.empty() && frame % opts.captureEvery == 0) {
+                capture.capture(realtime.getOutputFBO(), frame);
+            }
+            ++rendered;
+        }
+        capture.finish();
+        glFinish();
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << realtime.getProfiler().report();
+        std::cout << "state hash  " << std::hex << realtime.getSim().computeStateHash() << std::dec << "\n";
+
+        realtime.finish();
+    }
+    capture.destroy();
+
+    std::cout << "frames      " << rendered << "\n";
+    std::cout << "written     " << capture.getNumWritten() << "\n";
+    std::cout << "seconds     " << seconds << "\n";
+    if (seconds > 0.0) std::cout << "frames/sec  " << rendered / seconds << "\n";
+
+    context.doneCurrent();
+    return 0;
+}
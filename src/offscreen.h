@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+
+struct OffscreenOptions {
+    int width  = 1280;
+    int height = 720;
+    int frames = 300;          // one sim tick per frame
+    std::string outDir;        // empty = render only, write nothing
+    bool raw = false;          // frames.rgba instead of PNGs
+    int captureEvery = 1;      // write every Nth frame
+    std::string replayPath;    // drive the snake from an arena_replay file; else the batch bot
+    int clothCheck = 0;        // > 0: only run GpuCloth against the CPU reference for this many steps
+};
+
+// renders opts.frames frames into an FBO with no window and prints timings
+// (or runs the cloth check). Needs a QApplication; returns the process exit code
+int runOffscreen(const OffscreenOptions &opts);
@@ -136,24 +136,17 @@ void Portal::generateBorderGeometry(float borderWidth) {
     addToVector(innerVerts[3], m_borderVerts);      addToVector(outerVerts[0], m_borderVerts);      addToVector(innerVerts[0], m_borderVerts);
 }
 
-void Portal::render(GLuint shader,
+void Portal::render(ShaderProgram& shader,
                     const glm::mat4& mvp) const {
 
     // one sided portals :(
 
     // link portal shader
-    glUseProgram(shader);
+    shader.use();
 
-    // set uniforms
-    GLint loc = glGetUniformLocation(shader, "mvp");
-    if (loc != -1) {
-        glUniformMatrix4fv(loc, 1, GL_FALSE, &mvp[0][0]);
-    }
-
-    loc = glGetUniformLocation(shader, "portalColor");
-    if (loc != -1) {
-        glUniform3f(loc, m_color.x, m_color.y, m_color.z);
-    }
+    // set uniforms (inactive ones are ignored)
+    shader.set("mvp", mvp);
+    shader.set("portalColor", m_color);
 
     // bind and draw
     glBindVertexArray(m_vao);
@@ -164,24 +157,17 @@ void Portal::render(GLuint shader,
     glUseProgram(0);
 }
 
-void Portal::renderBorder(GLuint shader, const glm::mat4& mvp) const {
+void Portal::renderBorder(ShaderProgram& shader, const glm::mat4& mvp) const {
 
     // disable backface culling so we can see border from front and back
     glDisable(GL_CULL_FACE);
 
     // use shader provided, should be the border shader
-    glUseProgram(shader);
+    shader.use();
 
     // set uniforms
-    GLint loc = glGetUniformLocation(shader, "mvp");
-    if (loc != -1) {
-        glUniformMatrix4fv(loc, 1, GL_FALSE, &mvp[0][0]);
-    }
-
-    loc = glGetUniformLocation(shader, "borderColor");
-    if (loc != -1) {
-        glUniform3f(loc, m_color.x, m_color.y, m_color.z);
-    }
+    shader.set("mvp", mvp);
+    shader.set("borderColor", m_color);
 
     // draw arrays
     glBindVertexArray(m_borderVAO);
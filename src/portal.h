@@ -3,6 +3,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/glm.hpp>
 #include <GL/glew.h>
+#include "utils/shaderprogram.h"
 #include <memory>
 #include <vector>
 
@@ -64,7 +65,7 @@ public:
 
     // renders the other side of the portal quad for a given mvp matrix
     // marks the stencil buffer and depth buffer for a given shader
-    void render(GLuint shader, const glm::mat4& mvp) const;
+    void render(ShaderProgram& shader, const glm::mat4& mvp) const;
 
 
     // cleanup openGL stuff
@@ -82,7 +83,7 @@ public:
     // for border
     void setColor(const glm::vec3& color) { m_color = color; }
     glm::vec3 getColor() const { return m_color; }
-    void renderBorder(GLuint shader, const glm::mat4& mvp) const;
+    void renderBorder(ShaderProgram& shader, const glm::mat4& mvp) const;
     void renderColoredBack(GLuint shader,
                            const glm::mat4& mvp,
                            const glm::vec3& camPos) const;
@@ -11,13 +11,23 @@
 #include <unordered_map>
 #include <vector>
 #include <string>
-#include <deque>
 
 // Utils
+#include "utils/bloom.h"
 #include "utils/camera.h"
+#include "utils/clothmesh.h"
+#include "utils/frameprofiler.h"
 #include "utils/gbuffer.h"
+#include "utils/gpucloth.h"
+#include "utils/lightbuffer.h"
+#include "utils/tiledlighting.h"
+#include "utils/propbatch.h"
+#include "utils/propbvh.h"
 #include "utils/shaderloader.h"
-#include "utils/snakegame.h"
+#include "utils/shaderprogram.h"
+#include "sim/arenasim.h"
+#include "sim/inputrecording.h"
+#include "sim/rendersnapshot.h"
 #include "terraingenerator.h"
 #include "utils/cube.h"
 #include "utils/sphere.h"
@@ -36,6 +46,16 @@ public:
     void settingsChanged();
     void saveViewportImage(const std::string& path);
 
+    // --- OFFSCREEN (no window; see offscreen.cpp) ---
+    // caller has a context current; renders into an own width x height FBO.
+    // replay, if given, sets up the arena and must outlive this widget
+    void initializeOffscreen(int width, int height, const InputRecording *replay = nullptr);
+    // one sim tick, then a full frame into getOutputFBO()
+    void renderOffscreenFrame(float dt, const InputFrame &input, bool playing);
+    GLuint getOutputFBO() const { return m_defaultFBO; }
+    const ArenaSim &getSim() const { return m_sim; }
+    FrameProfiler &getProfiler() { return m_profiler; }
+
 protected:
     void initializeGL() override;
     void paintGL() override;
@@ -71,18 +91,49 @@ private:
     GBuffer m_gbuffer;
     GLuint m_defaultFBO = 2;
 
-    GLuint m_gbufferShader   = 0;
-    GLuint m_deferredShader  = 0;
-    GLuint m_blurShader      = 0;
-    GLuint m_compositeShader = 0;
+    // offscreen mode: m_defaultFBO is m_offscreenFBO and never re-queried
+    bool m_offscreen = false;
+    glm::ivec2 m_offscreenSize = glm::ivec2(0);
+    GLuint m_offscreenFBO = 0;
+    GLuint m_offscreenColor = 0;
+    GLuint m_offscreenDepth = 0;
+    const InputRecording *m_replay = nullptr;
+
+    // pixels of the render target (widget size * dpr, or the offscreen size)
+    glm::ivec2 framebufferSize() const;
+
+    ShaderProgram m_gbufferShader;
+    ShaderProgram m_gbufferInstancedShader;
+    ShaderProgram m_deferredShader;
+    ShaderProgram m_compositeShader;
+
+    // handles for uniforms set per draw
+    struct GBufferUniforms {
+        ShaderProgram::Uniform model = -1, albedo = -1, emissive = -1, useTexture = -1;
+    } m_gbufferUniforms;
+    ShaderProgram::Uniform m_instancedUseTexture = -1;   // on m_gbufferInstancedShader
+
+    LightBuffer m_lightBuffer;   // LightBlock UBO for m_deferredShader
+    TiledLighting m_tiledLighting;
+    TiledLighting::BindUniforms m_tiledUniforms;   // on m_deferredShader
+    bool m_useTiledLighting = true;
+
+    // a light's range ends where its falloff drops below this
+    static constexpr float LIGHT_CUTOFF = 0.2f;
 
     GLuint m_quadVAO = 0;
     GLuint m_quadVBO = 0;
 
     GLuint m_lightingFBO = 0;
     GLuint m_lightingTexture = 0;
-    GLuint m_pingpongFBO[2] = {0, 0};
-    GLuint m_pingpongColorbuffers[2] = {0, 0};
+    Bloom m_bloom;   // glow from the emissive target
+
+    // weight of the summed bloom chain in composite.frag
+    static constexpr float BLOOM_STRENGTH = 0.25f;
+
+    FrameProfiler m_profiler;   // per-pass GPU times, tick / paint CPU times
+    bool m_showProfiler = false;
+    void drawProfilerOverlay();
 
     // --- NEON ARENA DATA ---
     struct ArenaProp {
@@ -93,18 +144,12 @@ private:
         GLuint textureID; // 5th Argument
     };
     std::vector<ArenaProp> m_props;
+    PropBatch m_propBatch;   // m_props as instances, rebuilt by buildNeonScene()
+    PropBVH m_propBVH;       // m_props boxes, same ids as m_propBatch
+    std::vector<int> m_visibleProps;
+    bool m_cullProps = true;
 
-    struct SimpleLight {
-        glm::vec3 pos;
-        glm::vec3 vel;    // 2nd Argument (Physics)
-        glm::vec3 color;
-        float radius;
-    };
-    std::vector<SimpleLight> m_lights;
-
-    std::vector<std::vector<int>> m_mazeGrid;
-    const int GRID_SIZE = 60;
-    const float GRID_SCALE = 1.0f;
+    void uploadProps();
 
     // --- RESOURCES ---
     GLuint m_cubeVAO = 0;
@@ -119,133 +164,48 @@ private:
     GLuint m_grassDiffuseTex = 0;
     GLuint m_wallTexture = 0;
 
-    SnakeGame m_snake;
-
-    // --- SIMPLE SNAKE (STEP 1: HEAD ONLY) ---
-    struct SnakeState {
-        glm::vec3 pos; // center of cube
-        glm::vec3 vel;
-    };
-
-    SnakeState m_snakeState;
-
-    // Body segments
-    std::vector<glm::vec3> m_snakeBody;
-
-    // High-res trail for body following
-    std::deque<glm::vec3> m_snakeTrail;
-    glm::vec3 m_lastTrailPos = glm::vec3(0.f);
-    float     m_trailAccumDist = 0.f;
-    float     m_trailSampleDist = 0.4f;   // spacing along trail
-
-    glm::vec3 m_snakeForceDir = glm::vec3(0.f);
-
-    float m_snakeMass       = 1.0f;
-    float m_snakeForceMag   = 70.0f;  // input strength
-    float m_snakeFriction   = 8.0f;   // damping
-    float m_snakeMaxSpeed   = 8.0f;   // clamp
-
-    // jump
-    float m_snakeJumpOffset  = 0.0f;
-    float m_snakeJumpVel     = 0.0f;
-    float m_snakeJumpImpulse = 7.0f;
-    float m_snakeGravity     = 20.0f;
-    bool  m_snakeOnGround    = true;
-
-    void updateSnakeForceDirFromKeys();
-
-    // --- Food / powerup types ---
-    enum FoodType {
-        FOOD_NORMAL = 0,
-        FOOD_SPEED  = 1,
-        FOOD_JUMP   = 2
-    };
-
-    // --- FOOD ---
-    glm::vec3 m_foodPos      = glm::vec3(0.f);
-    bool      m_hasFood      = false;
-    float     m_foodRadius   = 1.2f;   // collision radius
-
-    FoodType  m_foodType   = FOOD_NORMAL;
+    // --- GAMEPLAY (headless simulation) ---
+    ArenaSim m_sim;
+    InputRecording m_recording;   // only fed when settings.recordPath is set
+    bool m_jumpQueued = false;   // space pressed, waiting for the next sim tick
 
-    // --- Power-up state ---
-    bool  m_speedBoostActive = false;
-    float m_speedBoostTimer  = 0.f;
-    float m_speedBoostDuration = 7.0f;   // seconds
+    InputFrame inputFromKeys() const;
 
-    bool  m_jumpBoostActive  = false;
-    float m_jumpBoostTimer   = 0.f;
-    float m_jumpBoostDuration = 7.0f;    // seconds
+    // the sim ticks at ArenaSim::FIXED_DT, frames come at display rate and
+    // draw m_renderState, blended between the last two ticks
+    RenderSnapshot m_prevState;
+    RenderSnapshot m_currState;
+    RenderSnapshot m_renderState;
+    float m_tickAlpha = 1.f;   // where m_renderState sits between the two
+    void tickSim();
 
     // --- FOOD MESH (sphere) ---
     GLuint m_sphereVAO       = 0;
     GLuint m_sphereVBO       = 0;
     int    m_sphereNumVerts  = 0;
 
-    struct Laser {
-        glm::vec3 center;    // base center position
-        glm::vec3 axis;      // (1,0,0) for X-aligned, (0,0,1) for Z-aligned
-        float length;
-        float thickness;
-        float speed;         // how fast it sweeps
-        float phase;         // per-laser offset
-        glm::vec3 color;     // bright "volt" colour
-        float emissive;      // emissive strength
-    };
-
-    // Cloth ghost settings
-    static const int GHOST_W = 18;   // wider
-    static const int GHOST_H = 6;    // grid height
-
-    struct GhostParticle {
-        glm::vec3 pos;
-        glm::vec3 vel;
-        bool pinned;
-    };
-
-
-    float m_ghostRestLenX = 0.45f;   // spacing left–right
-    float m_ghostRestLenZ = 0.28f;   // spacing front–back
-
-
-
-    glm::vec3 m_ghostOffset = glm::vec3(0.0f, 1.2f, 0.0f); // tweak 1.0–1.4 to taste
-    float     m_ghostRadius = 0.7f;                        // invisible head sphere
-
-
-
-    float m_ghostTime = 0.0f; // for wind
-
-    GhostParticle m_ghost[GHOST_W * GHOST_H];
-
-    float m_ghostRestX;      // rest length horizontally
-    float m_ghostRestZ;      // rest length vertically
-    float m_ghostK;          // spring stiffness
-    float m_ghostDamping;    // velocity damping
-    float m_ghostMass;       // mass per particle
-
-    // helper
-    int ghostIndex(int x, int y) const;
-    void initGhostCloth(const glm::vec3 &bossPos);
-    bool isGhostPinned(int x, int y) const;
-    void updateGhostCloth(float dt, const glm::vec3 &bossPos, const glm::vec3 &bossVel);
     void drawGhostCloth();   // called from paintGL()
-    //END OF GHOST STUFF
 
     // ---- Cloth ghost rendering ----
-    float m_bossPulseTime = 0.f;
-    GLuint m_ghostVAO = 0;
-    GLuint m_ghostVBO = 0;
-    int    m_ghostNumVerts = 0;
-
-    void initGhostBuffers();
-
-
-
+    ClothMesh m_ghostMesh;   // GhostCloth::W x H, indexed, streamed from m_renderState
+
+    // GPU backend (settings.gpuCloth, G key): the sim only counts cloth
+    // steps (ArenaSim::setExternalCloth) and m_gpuCloth replays them on the
+    // GPU, drawn straight from its buffers
+    GpuCloth m_gpuCloth;
+    ShaderProgram m_gbufferClothShader;
+    GBufferUniforms m_gbufferClothUniforms;   // no model, already world space
+    GpuCloth::DrawUniforms m_gpuClothUniforms;
+    bool m_useGpuCloth = false;
+    bool m_gpuClothLive = false;       // seeded from the current boss's cloth
+    uint64_t m_gpuClothSteps = 0;      // sim cloth steps already run on the GPU
+
+    void setGpuCloth(bool on);
+    void syncGpuCloth();       // after every sim tick
+    void beforeSimTick();      // m_prevState + GPU cloth bookkeeping
 
     // --- HELPERS ---
     void buildNeonScene();
-    void updateLightPhysics();
     void drawVoxelText(glm::vec3 startPos, std::string text, glm::vec3 color, float scale, GLuint texID);
 
     void initCube();
@@ -253,37 +213,12 @@ private:
     void initTerrain();
 
     void initSphere();
-    void resetSnake();
-
-    // --- Snake death / squish animation ---
-    bool  m_snakeDead      = false;
-    float m_deathTimer     = 0.0f;
-    float m_deathDuration  = 0.25f; // length of squish animation (seconds)
-
-    // Round timer -> when this hits 0, boss wakes up
-    float m_roundTime   = 20.0f;  // total seconds per round
-    float m_timeLeft    = 20.0f;
-
-    // Boss (chaser) data
-    bool        m_bossActive   = false;
-    glm::vec3   m_bossPos      = glm::vec3(0.f);
-    glm::vec3   m_bossVel      = glm::vec3(0.f);
-    float       m_bossSpeed    = 9.0f;   // slightly faster than snake max
-    float       m_bossHitRadius = 1.8f;   // collision radius with snake head
-
-
-    void startSnakeDeath();
-    bool snakeHeadHitsWall() const;
 
-    void spawnFood();
     GLuint loadTexture2D(const std::string &path);
 
     // portal things
-    bool checkPortalTeleport(glm::vec3& pos, glm::vec3& vel);
     void makePortals();
-    const float m_portalRadius = 28.0f;
-    const float m_portalWidth = 8.0f;
-    float m_teleportCooldown = 0.0f;
     std::vector<std::shared_ptr<Portal>> m_portals;
-    GLuint portalShader = 0; GLuint portalBorderShader = 0;
+    ShaderProgram m_portalShader;
+    ShaderProgram m_portalBorderShader;
 };
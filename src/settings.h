@@ -15,6 +15,10 @@ struct Settings {
     bool extraCredit2 = false;
     bool extraCredit3 = false;
     bool extraCredit4 = false;
+    std::string recordPath;   // --record <file>: save this session's inputs for arena_replay
+    int bouncingLights = 0;   // --lights N: override the arena's bouncing light count (0 = default)
+    bool compactGBuffer = false; // --gbuffer full|compact: G-buffer layout chosen at init
+    bool gpuCloth = false;       // --cloth gpu: boss cloth on the GPU (G toggles at runtime)
 };
 
 
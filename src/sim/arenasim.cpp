@@ -0,0 +1,602 @@
+#include "sim/arenasim.h"
+#include "sim/inputrecording.h"
+#include <algorithm>
+#include <cmath>
+
+void ArenaSim::buildArena(uint64_t seed) {
+    m_seed = seed;
+    m_rng.reseed(seed);
+    m_stats = SimStats();
+    m_lights.clear();
+    m_mazeWalls.clear();
+    m_mazeGrid.reset(GRID_SIZE, GRID_SIZE);
+    m_bossField.invalidate();
+
+    // --- SETTINGS (match the stadium built in Realtime::buildNeonScene) ---
+    const int RADIUS = 28;
+    const float WALL_H = 3.5f;
+    const float INNER_THICK = 0.8f;
+
+    // Portal Lights
+    glm::vec3 cPortal(1.0f, 0.0f, 1.0f); // Magenta
+    m_lights.addStatic(glm::vec3(-RADIUS, 1.0f, 0), cPortal);
+    m_lights.addStatic(glm::vec3( RADIUS, 1.0f, 0), cPortal);
+
+    // CIRCUIT BOARD MAZE (Sleek inner walls, No Texture)
+    auto getRainbow = [](float t) {
+        return glm::vec3(0.5f+0.5f*sin(t), 0.5f+0.5f*sin(t+2.0f), 0.5f+0.5f*sin(t+4.0f));
+    };
+
+    for (int x = 6; x < RADIUS - 4; x += 10) {
+        for (int z = 6; z < RADIUS - 4; z += 10) {
+            glm::vec3 color = getRainbow(x * 0.1f + z * 0.1f);
+            glm::vec3 glassColor = color * 0.15f;
+            int type = m_rng.nextInt(4);
+            std::vector<glm::vec3> shapes;
+            if (type == 0) { shapes.push_back({0,0,0}); shapes.push_back({0,0,2}); shapes.push_back({0,0,-2}); }
+            else if (type == 1) { shapes.push_back({0,0,0}); shapes.push_back({2,0,0}); shapes.push_back({-2,0,0}); }
+            else if (type == 2) { shapes.push_back({0,0,0}); shapes.push_back({2,0,0}); shapes.push_back({0,0,2}); }
+            else { shapes.push_back({0,0,0}); shapes.push_back({2,0,0}); shapes.push_back({-2,0,0}); shapes.push_back({2,0,2}); shapes.push_back({-2,0,2}); }
+
+            for (auto& offset : shapes) {
+                float q1x = x + offset.x; float q1z = z + offset.z;
+                glm::vec3 hScale(INNER_THICK, WALL_H, 2.0f);
+                glm::vec3 wScale(2.0f, WALL_H, INNER_THICK);
+                glm::vec3 finalScale = (type == 1 || (type > 1 && offset.z == 0)) ? wScale : hScale;
+                std::vector<glm::vec3> positions = { { q1x, WALL_H/2.0f - 0.5f, q1z }, { -q1x, WALL_H/2.0f - 0.5f, q1z }, { q1x, WALL_H/2.0f - 0.5f, -q1z }, { -q1x, WALL_H/2.0f - 0.5f, -q1z } };
+                for(auto& p : positions) {
+                    m_mazeWalls.push_back({ p, finalScale, glassColor, 4.0f });
+                    int rX = (int)(finalScale.x/2.0f)+1; int rZ = (int)(finalScale.z/2.0f)+1;
+                    m_mazeGrid.fillRect((int)(p.x - rX) + GRID_SIZE/2, (int)(p.z - rZ) + GRID_SIZE/2,
+                                        (int)(p.x + rX) + GRID_SIZE/2, (int)(p.z + rZ) + GRID_SIZE/2);
+                }
+            }
+        }
+    }
+
+    // BOUNCING LIGHTS
+    for(int i=0; i<m_numBouncingLights; i++) {
+        float rX = m_rng.nextInt(RADIUS*2) - RADIUS; float rZ = m_rng.nextInt(RADIUS*2) - RADIUS;
+        int gx = (int)(rX) + GRID_SIZE/2; int gz = (int)(rZ) + GRID_SIZE/2;
+        if(m_mazeGrid.test(gx, gz)) continue;
+        float vx = (m_rng.nextInt(100) / 100.0f - 0.5f) * 0.3f; float vz = (m_rng.nextInt(100) / 100.0f - 0.5f) * 0.3f;
+        if (std::abs(vx) < 0.05f) vx = 0.1f;
+        glm::vec3 color = getRainbow(i * 0.3f);
+        // speeds were tuned as per-60Hz-tick steps; the store wants units / second
+        m_lights.addBouncing(glm::vec3(rX, 1.5f, rZ), glm::vec3(vx, 0, vz) * 60.0f, color);
+    }
+
+    resetSnake();
+}
+
+int ArenaSim::advance(float frameTime, const InputFrame &input,
+                      const std::function<void()> &beforeTick) {
+    m_accumulator += std::min(frameTime, MAX_FRAME_TIME);
+
+    InputFrame tickInput = input;
+    int steps = 0;
+    while (m_accumulator >= FIXED_DT) {
+        if (beforeTick) beforeTick();
+        step(FIXED_DT, tickInput);
+        tickInput.jump = false;   // a jump press only fires on the first tick
+        m_accumulator -= FIXED_DT;
+        ++steps;
+    }
+    return steps;
+}
+
+void ArenaSim::step(float deltaTime, const InputFrame &input) {
+    if (m_recorder) m_recorder->record(input, m_playing);
+
+    m_stats.ticks++;
+    m_bossPulseTime += deltaTime;
+
+    // --- Power-up timers ---
+    if (m_speedBoostActive) {
+        m_speedBoostTimer -= deltaTime;
+        if (m_speedBoostTimer <= 0.f) {
+            m_speedBoostActive = false;
+            m_speedBoostTimer  = 0.f;
+        }
+    }
+
+    if (m_jumpBoostActive) {
+        m_jumpBoostTimer -= deltaTime;
+        if (m_jumpBoostTimer <= 0.f) {
+            m_jumpBoostActive = false;
+            m_jumpBoostTimer  = 0.f;
+        }
+    }
+
+    // Lights keep bouncing
+    m_lights.update(deltaTime, m_mazeGrid, 28.0f);
+
+    // If snake is in death animation, just advance timer
+    if (m_snakeDead) {
+        m_deathTimer += deltaTime;
+        if (m_deathTimer >= m_deathDuration) {
+            resetSnake();
+        }
+        return;
+    }
+
+    if (!m_playing) {
+        return;
+    }
+
+    // ======= 0) INPUT =======
+    m_snakeForceDir = input.moveDir;
+
+    if (input.jump && m_snakeOnGround) {
+        m_snakeOnGround = false;
+
+        float jumpImpulse = m_snakeJumpImpulse;
+        if (m_jumpBoostActive) {
+            jumpImpulse *= 1.7f;   // jump higher when boosted
+        }
+
+        m_snakeJumpVel = jumpImpulse;
+    }
+
+    // ======= 1) SNAKE PHYSICS (head) =======
+    // Force from WASD
+    glm::vec3 F_input = m_snakeForceDir * m_snakeForceMag;
+    glm::vec3 F_fric  = -m_snakeVel * m_snakeFriction;
+    glm::vec3 F_total = F_input + F_fric;
+
+    glm::vec3 a = F_total / m_snakeMass;
+    m_snakeVel += a * deltaTime;
+
+    // Clamp speed (with possible boost)
+    float maxSpeed = m_snakeMaxSpeed;
+    if (m_speedBoostActive) {
+        maxSpeed *= 1.8f;
+    }
+
+    float speed = glm::length(m_snakeVel);
+    if (speed > maxSpeed) {
+        m_snakeVel = (m_snakeVel / speed) * maxSpeed;
+    }
+
+    // Integrate position on XZ plane
+    m_prevSnakePos = m_snakePos;
+    m_snakePos += m_snakeVel * deltaTime;
+    m_snakePos.y = 1.0f;   // stay on floor plane
+
+    // handle teleports
+    if (checkPortalTeleport(m_snakePos)) {
+        m_prevSnakePos = m_snakePos;   // don't sweep across the arena
+        m_trailJumped = true;
+        for (size_t i = 0; i < std::min((size_t)8, m_snakeTrail.size()); i++)  {
+            checkPortalTeleport(m_snakeTrail.at(i));
+        }
+    }
+
+    // update teleport cooldown
+    if (m_teleportCooldown > 0.0f) {
+        m_teleportCooldown -= deltaTime;
+    }
+
+    // Jump motion
+    if (!m_snakeOnGround) {
+        m_snakeJumpVel    -= m_snakeGravity * deltaTime;
+        m_snakeJumpOffset += m_snakeJumpVel * deltaTime;
+
+        if (m_snakeJumpOffset <= 0.f) {
+            m_snakeJumpOffset = 0.f;
+            m_snakeJumpVel    = 0.f;
+            m_snakeOnGround   = true;
+        }
+    }
+
+    // ======= 2) UPDATE TRAIL =======
+    float stepDist = glm::length(m_snakePos - m_lastTrailPos);
+    m_trailAccumDist += stepDist;
+
+    if (m_trailAccumDist >= m_trailSampleDist) {
+        // Keep a reasonable trail length
+        m_snakeTrail.setMaxSamples((m_snakeBody.size() + 5) * 8);
+        m_snakeTrail.push(m_snakePos, m_trailJumped);
+        m_trailJumped    = false;
+        m_lastTrailPos   = m_snakePos;
+        m_trailAccumDist = 0.f;
+    }
+
+    // ======= 3) BODY SEGMENTS FOLLOW TRAIL =======
+    // same gap as the old "every 6th sample" rule, but measured in arc length
+    m_snakeTrail.sampleSpaced(6.0f * m_trailSampleDist, m_snakeBody, m_snakePos);
+    for (size_t i = 0; i < m_snakeBody.size(); ++i) {
+        int before = m_bodyHash.getCell(int(i));
+        m_bodyHash.update(int(i), m_snakeBody[i]);
+        int after = m_bodyHash.getCell(int(i));
+        if (after != before) {
+            m_freeCells.unblock(before);
+            m_freeCells.block(after);
+        }
+    }
+
+    // ======= 4) FOOD COLLISION =======
+    for (size_t f = 0; f < m_food.size(); ) {
+        glm::vec3 d = m_snakePos - m_food[f].pos;
+        if (glm::dot(d, d) >= m_foodRadius * m_foodRadius) {
+            ++f;
+            continue;
+        }
+
+        // All food types still grow the snake a bit
+        glm::vec3 newSeg = m_snakePos;
+        if (!m_snakeBody.empty()) {
+            newSeg = m_snakeBody.back();
+        }
+        m_snakeBody.push_back(newSeg);
+        m_bodyHash.resize(m_snakeBody.size());
+        m_bodyHash.update(int(m_snakeBody.size()) - 1, newSeg);
+        m_freeCells.block(m_bodyHash.getCell(int(m_snakeBody.size()) - 1));
+
+        // Apply effect based on type
+        if (m_food[f].type == FOOD_SPEED) {
+            m_speedBoostActive = true;
+            m_speedBoostTimer  = m_speedBoostDuration;
+        }
+        else if (m_food[f].type == FOOD_JUMP) {
+            m_jumpBoostActive = true;
+            m_jumpBoostTimer  = m_jumpBoostDuration;
+        }
+
+        m_stats.foodEaten++;
+        m_freeCells.unblock(m_food[f].cell);
+        m_food[f] = m_food.back();
+        m_food.pop_back();
+    }
+    refillFood();
+
+    // ======= 4.5) SELF-COLLISION (HEAD VS BODY) =======
+    {
+        // We skip the first few segments so tiny overlaps / jitter
+        // near the neck don't insta-kill you.
+        const float headHitRadius = 1.7f;  // pretty close, but forgiving
+
+        if (m_bodyHash.findWithin(m_snakePos, headHitRadius, m_snakeBody, 1) >= 0) {
+            startSnakeDeath();
+        }
+    }
+
+    // ======= 5) WALL COLLISION (head) =======
+    if (!m_snakeDead && snakeHeadHitsWall()) {
+        // squish where the head met the wall, not past it
+        m_snakePos.x = m_lastWallHit.pos.x;
+        m_snakePos.z = m_lastWallHit.pos.z;
+        startSnakeDeath();
+    }
+
+    // ======= 5B) TIMER + BOSS WAKE-UP =======
+    if (!m_bossActive) {
+        m_timeLeft -= deltaTime;
+        if (m_timeLeft <= 0.f) {
+            m_timeLeft   = 0.f;
+            m_bossActive = true;
+
+            // Spawn boss somewhere away from player
+            m_bossPos = glm::vec3(-24.f, 1.0f, 24.f);
+            m_bossVel = glm::vec3(0.f);
+            m_ghost.init(m_bossPos);
+            m_clothTicks   = 0;
+            m_clothPending = 0.f;
+        }
+    }
+
+    // ======= 6) BOSS PATHFIND CHASE =======
+    if (m_bossActive) {
+
+        // Shared BFS field toward the snake, only rebuilt when it changes cell
+        m_bossField.setTarget(m_mazeGrid, GridCoords::toCell(m_snakePos.x),
+                              GridCoords::toCell(m_snakePos.z));
+
+        // Head for the next cell on the path; in the snake's own cell go
+        // straight for the head, unless it's above a wall (then wait beside it)
+        glm::vec3 target;
+        if (!m_bossField.nextWaypoint(m_bossPos, target)) {
+            const int sx = GridCoords::toCell(m_snakePos.x), sz = GridCoords::toCell(m_snakePos.z);
+            target = m_mazeGrid.test(sx, sz) ? m_bossPos : m_snakePos;
+        }
+
+        // Smooth move toward the next tile, stopping on it rather than past
+        glm::vec3 delta = target - m_bossPos;
+        delta.y = 0.f;
+        float dist = glm::length(delta);
+        if (dist > 0.001f) {
+            float step = m_bossSpeed * deltaTime;
+            if (step >= dist) {
+                m_bossPos.x = target.x;
+                m_bossPos.z = target.z;
+            } else {
+                m_bossPos += (delta / dist) * step;
+            }
+            m_bossPos.y = 1.0f;
+            m_clothPending += deltaTime;
+            if (++m_clothTicks >= m_clothInterval) {
+                if (!m_externalCloth) m_ghost.update(m_clothPending, m_bossPos);
+                m_clothSteps++;
+                m_clothStepDt  = m_clothPending;
+                m_clothTicks   = 0;
+                m_clothPending = 0.f;
+            }
+        }
+
+        // Boss-snake collision
+        if (glm::length(m_bossPos - m_snakePos) < m_bossHitRadius) {
+            startSnakeDeath();
+        }
+    }
+}
+
+uint64_t ArenaSim::computeStateHash() const {
+    uint64_t h = 1469598103934665603ULL;
+    auto mix = [&h](const void *data, size_t bytes) {
+        const unsigned char *p = static_cast<const unsigned char *>(data);
+        for (size_t i = 0; i < bytes; ++i) {
+            h ^= p[i];
+            h *= 1099511628211ULL;
+        }
+    };
+    auto mixValue = [&mix](const auto &v) { mix(&v, sizeof(v)); };
+
+    uint64_t rng = m_rng.getState();
+    mixValue(rng);
+    mixValue(m_stats.ticks); mixValue(m_stats.foodEaten); mixValue(m_stats.deaths);
+
+    mixValue(m_snakePos); mixValue(m_snakeVel); mixValue(m_prevSnakePos);
+    mixValue(m_snakeJumpOffset); mixValue(m_snakeJumpVel); mixValue(m_snakeOnGround);
+    mix(m_snakeBody.data(), m_snakeBody.size() * sizeof(glm::vec3));
+    mixValue(m_snakeDead); mixValue(m_deathTimer);
+
+    // the trail the body is laid along
+    const size_t trailSize = m_snakeTrail.size();
+    mixValue(trailSize);
+    for (size_t k = 0; k < trailSize; ++k) {
+        mixValue(m_snakeTrail.at(k));
+        double arc = m_snakeTrail.arcLengthAt(k);
+        mixValue(arc);
+    }
+    mixValue(m_lastTrailPos); mixValue(m_trailAccumDist); mixValue(m_trailJumped);
+
+    mixValue(m_foodTarget);
+    for (const FoodItem &food : m_food) {
+        mixValue(food.pos); mixValue(food.type);
+    }
+
+    mixValue(m_speedBoostActive); mixValue(m_speedBoostTimer);
+    mixValue(m_jumpBoostActive); mixValue(m_jumpBoostTimer);
+    mixValue(m_timeLeft); mixValue(m_teleportCooldown);
+    mixValue(m_bossActive); mixValue(m_bossPos); mixValue(m_bossVel); mixValue(m_bossPulseTime);
+    mixValue(m_clothTicks); mixValue(m_clothPending);
+
+    for (int i = 0; i < m_lights.size(); ++i) {
+        glm::vec3 pos = m_lights.getPos(i), vel = m_lights.getVel(i);
+        mixValue(pos); mixValue(vel);
+    }
+    const ClothGrid<GhostCloth::W, GhostCloth::H> &cloth = m_ghost.getGrid();
+    float clothTime = cloth.getTime();
+    mixValue(clothTime);
+    for (int y = 0; y < GhostCloth::H; ++y) {
+        for (int x = 0; x < GhostCloth::W; ++x) {
+            mixValue(cloth.getPos(x, y)); mixValue(cloth.getVel(x, y));
+        }
+    }
+    return h;
+}
+
+float ArenaSim::getDeathProgress() const {
+    if (!m_snakeDead || m_deathDuration <= 0.0f) return 0.0f;
+    return glm::clamp(m_deathTimer / m_deathDuration, 0.0f, 1.0f);
+}
+
+bool ArenaSim::snakeHeadHitsWall() {
+    // Match arena radius used in buildArena / the light bounce in step()
+    const float arenaBounds = 28.0f;
+
+    // Head center position
+    glm::vec3 p = m_snakePos;
+    float headCenterY = 1.0f + m_snakeJumpOffset; // base y is 1.0
+    float headRadius  = 1.0f;                     // because scale = 2.f
+    float headBottomY = headCenterY - headRadius;
+
+    // Approximate top of the inner walls:
+    // WALL_H = 3.5, center y = WALL_H/2 - 0.5 → 1.25
+    // top ≈ 1.25 + WALL_H/2 = 3.0
+    const float wallTopY = 3.0f;
+
+    const float portalHW = m_portalWidth / 2.0f;
+    bool inPortalZone = (std::abs(p.x) > arenaBounds - 1.0f) &&
+                        (std::abs(p.z) < portalHW);
+
+    // --- 1) Outer arena bounds ---
+    if (!inPortalZone &&
+        (std::abs(p.x) > arenaBounds || std::abs(p.z) > arenaBounds) &&
+        headBottomY < wallTopY) {
+        m_lastWallHit = { GridCoords::toCell(p.x), GridCoords::toCell(p.z), 1.0f, p };
+        return true;
+    }
+
+    // --- 2) Maze walls using m_mazeGrid ---
+    // Sweep the whole tick's motion, not just where the head ended up, so a
+    // boosted head on a coarse timestep can't skip over a 0.8-unit wall.
+    // If the snake is high enough to clear the walls, nothing to do.
+    if (headBottomY >= wallTopY) {
+        return false;
+    }
+    return sweepMaze(m_prevSnakePos, p, m_lastWallHit);
+}
+
+bool ArenaSim::sweepMaze(const glm::vec3 &from, const glm::vec3 &to, WallHit &hit) const {
+    // Cells come from truncation (GridCoords::toCell), which is uniform on
+    // each side of an axis but folds (-1, 1) into one centre cell. Split the
+    // segment where it crosses x = 0 / z = 0; inside each piece, shifting the
+    // negative side by one cell makes it a plain floor grid for the DDA.
+    float cuts[4] = { 0.f, 1.f, 1.f, 1.f };
+    int numCuts = 1;
+    const float dx = to.x - from.x, dz = to.z - from.z;
+    if (dx != 0.f) { float t = -from.x / dx; if (t > 0.f && t < 1.f) cuts[numCuts++] = t; }
+    if (dz != 0.f) { float t = -from.z / dz; if (t > 0.f && t < 1.f) cuts[numCuts++] = t; }
+    if (numCuts == 3 && cuts[2] < cuts[1]) std::swap(cuts[1], cuts[2]);
+    cuts[numCuts] = 1.f;
+
+    const float half = float(GRID_SIZE / 2);
+    for (int i = 0; i < numCuts; ++i) {
+        const float t0 = cuts[i], t1 = cuts[i + 1];
+        if (t1 <= t0 && i > 0) continue;
+
+        glm::vec3 a = from + (to - from) * t0;
+        glm::vec3 b = from + (to - from) * t1;
+        glm::vec3 mid = (a + b) * 0.5f;
+        const float shiftX = (mid.x < 0.f) ? 1.f : 0.f;
+        const float shiftZ = (mid.z < 0.f) ? 1.f : 0.f;
+
+        int gx, gz;
+        float t;
+        if (m_mazeGrid.raycast(a.x / GRID_SCALE + half + shiftX, a.z / GRID_SCALE + half + shiftZ,
+                               b.x / GRID_SCALE + half + shiftX, b.z / GRID_SCALE + half + shiftZ,
+                               gx, gz, t)) {
+            hit.gx  = gx;
+            hit.gz  = gz;
+            hit.toi = t0 + (t1 - t0) * t;
+            hit.pos = from + (to - from) * hit.toi;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ArenaSim::startSnakeDeath() {
+    if (m_snakeDead) return; // already animating death
+
+    m_snakeDead  = true;
+    m_deathTimer = 0.0f;
+    m_stats.deaths++;
+
+    // clear input so it doesn't "queue" movement
+    m_snakeForceDir = glm::vec3(0.f);
+    m_snakeVel      = glm::vec3(0.f);
+}
+
+bool ArenaSim::checkPortalTeleport(glm::vec3 &pos) {
+    const float hw = m_portalWidth * 0.5f;  // half portal width
+
+    if (m_teleportCooldown > 0.0f) {
+        return false;
+    }
+
+    // left -> right
+    if (pos.x < -m_portalRadius && std::abs(pos.z) < hw) {
+        pos.x = m_portalRadius - 1.0f;
+        m_teleportCooldown = 0.2f;
+        return true;
+    }
+
+    // right -> left
+    if (pos.x > m_portalRadius && std::abs(pos.z) < hw) {
+        pos.x = -m_portalRadius + 1.0f;
+        m_teleportCooldown = 0.2f;
+        return true;
+    }
+
+    return false;
+}
+
+//When snake dies/ to spawn snake
+void ArenaSim::resetSnake() {
+    // head
+    m_snakePos      = glm::vec3(0.f, 1.0f, 0.f);
+    m_prevSnakePos  = m_snakePos;
+    m_snakeVel      = glm::vec3(0.f);
+    m_snakeForceDir = glm::vec3(0.f);
+
+    // jump
+    m_snakeJumpOffset = 0.f;
+    m_snakeJumpVel    = 0.f;
+    m_snakeOnGround   = true;
+
+    // trail + body
+    m_snakeTrail.clear();
+    m_snakeBody.clear();
+    m_bodyHash.clear();
+    m_lastTrailPos    = m_snakePos;
+    m_trailAccumDist  = 0.f;
+    m_trailJumped     = false;
+    m_trailSampleDist = 1.2f;   // spacing between samples (tweak feel)
+
+    // food
+    m_foodRadius = 2.0f;       // works with 2.0f sphere scale
+    resetFreeCells();
+    m_food.clear();
+    refillFood();
+
+    // Reset death animation state
+    m_snakeDead     = false;
+    m_deathTimer    = 0.0f;
+    m_deathDuration = 0.25f;
+
+    m_bossActive = false;
+    m_bossPos    = glm::vec3(0.f);   // doesn't matter, not drawn when inactive
+    m_bossVel    = glm::vec3(0.f);
+    m_timeLeft   = m_roundTime;
+    m_ghost.init(m_bossPos);
+    m_clothTicks   = 0;
+    m_clothPending = 0.f;
+
+    m_speedBoostActive = false;
+    m_speedBoostTimer  = 0.f;
+    m_jumpBoostActive  = false;
+    m_jumpBoostTimer   = 0.f;
+}
+
+void ArenaSim::resetFreeCells() {
+    // food stays slightly inside the walls
+    const float arenaBounds = 26.0f;
+    const float margin      = 3.0f;
+    const int lo = GridCoords::toCell(-(arenaBounds - margin));
+    const int hi = GridCoords::toCell(arenaBounds - margin);
+    m_freeCells.reset(m_mazeGrid, lo, lo, hi, hi);
+}
+
+void ArenaSim::setFoodCount(int count) {
+    m_foodTarget = std::max(count, 0);
+    while ((int)m_food.size() > m_foodTarget) {
+        m_freeCells.unblock(m_food.back().cell);
+        m_food.pop_back();
+    }
+    refillFood();
+}
+
+void ArenaSim::refillFood() {
+    while ((int)m_food.size() < m_foodTarget && spawnFood()) {}
+}
+
+bool ArenaSim::spawnFood() {
+    // Random type: 0 = normal, 1 = speed, 2 = jump
+    int r = m_rng.nextInt(100);
+
+    FoodType type;
+    if (r < 70) {
+        type = FOOD_NORMAL;
+    }
+    else if (r < 85) {
+        type = FOOD_SPEED;
+    }
+    else {
+        type = FOOD_JUMP;
+    }
+
+    // One pick from the free cells (no walls, body or other food);
+    // if the board is full we just wait for a cell to open up
+    int cell = m_freeCells.pick(m_rng);
+    if (cell < 0) return false;
+
+    int gx = cell % m_freeCells.getWidth();
+    int gz = cell / m_freeCells.getWidth();
+    glm::vec3 pos(GridCoords::cellCenter(gx), 1.0f, GridCoords::cellCenter(gz)); // same height as snake
+
+    m_freeCells.block(cell);
+    m_food.push_back({ pos, type, cell });
+    return true;
+}
@@ -0,0 +1,265 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "sim/flowfield.h"
+#include "sim/freecellindex.h"
+#include "sim/ghostcloth.h"
+#include "sim/lightstore.h"
+#include "sim/occupancygrid.h"
+#include "sim/gridcoords.h"
+#include "sim/simrandom.h"
+#include "sim/snaketrail.h"
+#include "sim/spatialhash.h"
+
+class InputRecording;
+
+// Player input sampled once per simulation tick.
+struct InputFrame {
+    glm::vec3 moveDir = glm::vec3(0.f); // normalized XZ steering direction (or zero)
+    bool      jump    = false;          // true on the tick the jump key went down
+};
+
+/**
+ * ArenaSim - all gameplay for one arena, with no GL / Qt dependency
+ *
+ * - snake head physics, trail and body segments
+ * - food + power-ups, self / wall collision, portal teleport
+ * - boss wake-up timer, chase and its ghost cloth
+ * - bouncing lights and the maze occupancy grid
+ *
+ * step() advances exactly one tick of length dt; advance() feeds a
+ * variable frame time through an accumulator so the game always runs
+ * on FIXED_DT ticks no matter how often it is called.
+ */
+class ArenaSim {
+public:
+    static constexpr int   GRID_SIZE  = GridCoords::GRID_SIZE;
+    static constexpr float GRID_SCALE = GridCoords::GRID_SCALE;
+
+    static constexpr float FIXED_DT       = 1.0f / 60.0f;
+    static constexpr float MAX_FRAME_TIME = 0.25f; // clamp so a hitch can't spiral
+
+    enum FoodType {
+        FOOD_NORMAL = 0,
+        FOOD_SPEED  = 1,
+        FOOD_JUMP   = 2
+    };
+
+    struct FoodItem {
+        glm::vec3 pos;
+        FoodType  type;
+        int       cell;   // maze grid cell, blocked in the free-cell index
+    };
+
+    // where a head sweep first met a wall this tick
+    struct WallHit {
+        int gx = -1, gz = -1;           // blocking maze cell
+        float toi = 0.f;                // [0,1] along the swept motion
+        glm::vec3 pos = glm::vec3(0.f); // head position at that moment
+    };
+
+    // inner maze walls, kept so the renderer can draw the same boxes
+    struct MazeWall {
+        glm::vec3 pos;
+        glm::vec3 scale;
+        glm::vec3 color;
+        float emissiveStrength;
+    };
+
+    // running totals since the last buildArena()
+    struct SimStats {
+        uint64_t ticks     = 0;
+        uint64_t foodEaten = 0;
+        uint64_t deaths    = 0;
+    };
+
+    // build maze grid + lights, then spawn the snake.
+    // everything random in the arena comes from seed, so two sims built
+    // with the same seed and fed the same input stay in lockstep
+    void buildArena(uint64_t seed = 1234);
+    void resetSnake();
+
+    // runs fixed ticks for frameTime seconds, returns how many ran.
+    // beforeTick (optional) runs before each one, e.g. to snapshot the
+    // state the tick starts from
+    int advance(float frameTime, const InputFrame &input,
+                const std::function<void()> &beforeTick = nullptr);
+
+    // how far real time is past the last tick, in ticks [0, 1)
+    float getTickAlpha() const { return m_accumulator / FIXED_DT; }
+
+    // one tick of length dt
+    void step(float dt, const InputFrame &input);
+
+    void setPlaying(bool playing) { m_playing = playing; }
+    bool isPlaying() const { return m_playing; }
+
+    uint64_t getSeed() const { return m_seed; }
+
+    // bouncing lights spawned by the next buildArena() (some land in walls
+    // and are skipped, so the final count can be lower)
+    void setBouncingLightCount(int n) { m_numBouncingLights = n; }
+    int getBouncingLightCount() const { return m_numBouncingLights; }
+
+    // every step() appends its input to rec (nullptr stops recording)
+    void setRecorder(InputRecording *rec) { m_recorder = rec; }
+
+    // FNV-1a over all state that carries into later ticks (snake and its
+    // trail, food, boosts, boss, lights, cloth positions and velocities,
+    // timers, RNG). equal hashes after the same inputs = bit-identical sims
+    uint64_t computeStateHash() const;
+
+    // --- state for the renderer ---
+    glm::vec3 getSnakePos() const { return m_snakePos; }
+    float getSnakeJumpOffset() const { return m_snakeJumpOffset; }
+    bool isSnakeOnGround() const { return m_snakeOnGround; }
+    const std::vector<glm::vec3> &getSnakeBody() const { return m_snakeBody; }
+
+    bool isSnakeDead() const { return m_snakeDead; }
+    float getDeathProgress() const; // [0,1] through the squish animation
+
+    const std::vector<FoodItem> &getFood() const { return m_food; }
+
+    // how many food items the arena keeps topped up (default 1)
+    void setFoodCount(int count);
+    int getFoodCount() const { return m_foodTarget; }
+
+    bool isBossActive() const { return m_bossActive; }
+    glm::vec3 getBossPos() const { return m_bossPos; }
+    float getBossPulseTime() const { return m_bossPulseTime; }
+    const GhostCloth &getGhostCloth() const { return m_ghost; }
+
+    // step the boss cloth only every n boss ticks (with the summed dt), e.g.
+    // on a server that doesn't need it smooth. default 1
+    void setClothInterval(int ticks) { m_clothInterval = ticks < 1 ? 1 : ticks; }
+    int getClothInterval() const { return m_clothInterval; }
+
+    // the cloth is simulated by someone else (the renderer's GpuCloth): the
+    // boss still counts its cloth steps, but m_ghost stays where it is. Its
+    // frozen positions go into the state hash, so recordings need this off
+    void setExternalCloth(bool external) { m_externalCloth = external; }
+    bool hasExternalCloth() const { return m_externalCloth; }
+    // cloth steps taken so far (never reset), and the dt of the last one
+    uint64_t getClothSteps() const { return m_clothSteps; }
+    float getClothStepDt() const { return m_clothStepDt; }
+
+    float getTimeLeft() const { return m_timeLeft; }
+
+    const LightStore &getLights() const { return m_lights; }
+    const std::vector<MazeWall> &getMazeWalls() const { return m_mazeWalls; }
+    const OccupancyGrid &getMazeGrid() const { return m_mazeGrid; }
+
+    // walks the maze cells under the XZ segment from -> to (DDA) and
+    // reports the first wall cell and time of impact
+    bool sweepMaze(const glm::vec3 &from, const glm::vec3 &to, WallHit &hit) const;
+    const WallHit &getLastWallHit() const { return m_lastWallHit; }
+
+    float getPortalRadius() const { return m_portalRadius; }
+    float getPortalWidth() const { return m_portalWidth; }
+
+    const SimStats &getStats() const { return m_stats; }
+
+private:
+    bool  m_playing     = false;
+    float m_accumulator = 0.f;
+
+    uint64_t  m_seed = 1234;
+    SimRandom m_rng;
+    SimStats  m_stats;
+    InputRecording *m_recorder = nullptr;
+
+    // --- ARENA ---
+    OccupancyGrid m_mazeGrid;   // 1 bit per GRID_SIZE x GRID_SIZE cell, set = wall
+    std::vector<MazeWall> m_mazeWalls;
+    LightStore m_lights;
+    int        m_numBouncingLights = 80;
+
+    // --- SNAKE HEAD ---
+    glm::vec3 m_snakePos = glm::vec3(0.f, 1.f, 0.f); // center of cube
+    glm::vec3 m_snakeVel = glm::vec3(0.f);
+    glm::vec3 m_prevSnakePos = glm::vec3(0.f, 1.f, 0.f); // start of this tick's motion
+
+    // Body segments
+    std::vector<glm::vec3> m_snakeBody;
+    SpatialHash m_bodyHash;   // segment index per grid cell, for self-collision
+
+    // High-res trail for body following
+    SnakeTrail m_snakeTrail;
+    glm::vec3 m_lastTrailPos = glm::vec3(0.f);
+    float     m_trailAccumDist = 0.f;
+    float     m_trailSampleDist = 1.2f;   // spacing along trail
+    bool      m_trailJumped = false;      // teleported since the last sample
+
+    glm::vec3 m_snakeForceDir = glm::vec3(0.f);
+
+    float m_snakeMass       = 1.0f;
+    float m_snakeForceMag   = 110.0f; // input strength
+    float m_snakeFriction   = 8.0f;   // damping
+    float m_snakeMaxSpeed   = 12.0f;  // clamp
+
+    // jump
+    float m_snakeJumpOffset  = 0.0f;
+    float m_snakeJumpVel     = 0.0f;
+    float m_snakeJumpImpulse = 12.0f;
+    float m_snakeGravity     = 20.0f;
+    bool  m_snakeOnGround    = true;
+
+    // --- FOOD ---
+    std::vector<FoodItem> m_food;
+    int           m_foodTarget = 1;
+    float         m_foodRadius = 2.0f;   // works with 2.0f sphere scale
+    FreeCellIndex m_freeCells;           // walkable cells not under the body / other food
+
+    bool spawnFood();
+    void refillFood();
+    void resetFreeCells();
+
+    // --- Power-up state ---
+    bool  m_speedBoostActive   = false;
+    float m_speedBoostTimer    = 0.f;
+    float m_speedBoostDuration = 7.0f;   // seconds
+
+    bool  m_jumpBoostActive   = false;
+    float m_jumpBoostTimer    = 0.f;
+    float m_jumpBoostDuration = 7.0f;    // seconds
+
+    // --- Snake death / squish animation ---
+    bool  m_snakeDead     = false;
+    float m_deathTimer    = 0.0f;
+    float m_deathDuration = 0.25f; // length of squish animation (seconds)
+
+    void startSnakeDeath();
+    bool snakeHeadHitsWall();   // fills m_lastWallHit on a hit
+    WallHit m_lastWallHit;
+
+    // Round timer -> when this hits 0, boss wakes up
+    float m_roundTime = 20.0f;  // total seconds per round
+    float m_timeLeft  = 20.0f;
+
+    // --- BOSS (chaser) ---
+    bool      m_bossActive    = false;
+    glm::vec3 m_bossPos       = glm::vec3(0.f);
+    glm::vec3 m_bossVel       = glm::vec3(0.f);
+    float     m_bossSpeed     = 9.0f;   // slightly faster than snake max
+    float     m_bossHitRadius = 1.8f;   // collision radius with snake head
+    float     m_bossPulseTime = 0.f;
+
+    GhostCloth m_ghost;
+    int   m_clothInterval = 1;
+    int   m_clothTicks    = 0;      // boss ticks since the cloth last stepped
+    float m_clothPending  = 0.f;    // and the time they covered
+    bool     m_externalCloth = false;
+    uint64_t m_clothSteps    = 0;
+    float    m_clothStepDt   = 0.f;
+    FlowField  m_bossField;   // BFS toward the snake's cell, shared by chasers
+
+    // --- PORTALS ---
+    bool checkPortalTeleport(glm::vec3 &pos);
+    const float m_portalRadius = 28.0f;
+    const float m_portalWidth  = 8.0f;
+    float m_teleportCooldown   = 0.0f;
+};
@@ -0,0 +1,82 @@
+#include "sim/batchrunner.h"
+#include "sim/threadpool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+
+BatchRunner::BatchRunner(const BatchConfig &config)
+    : m_config(config)
+{
+    m_config.arenas       = std::max(0, m_config.arenas);
+    m_config.ticksPerTask = std::max(1, m_config.ticksPerTask);
+
+    m_arenas.reserve(m_config.arenas);
+    for (int i = 0; i < m_config.arenas; ++i) {
+        auto sim = std::make_unique<ArenaSim>();
+        sim->buildArena(m_config.seed + uint64_t(i));
+        sim->setFoodCount(m_config.foodCount);
+        sim->setClothInterval(m_config.clothEvery);
+        sim->setPlaying(true);
+        m_arenas.push_back(std::move(sim));
+    }
+}
+
+InputFrame BatchRunner::botInput(const ArenaSim &sim) {
+    InputFrame input;
+
+    // nearest food item
+    float best = 1e30f;
+    glm::vec3 to(0.f);
+    for (const ArenaSim::FoodItem &food : sim.getFood()) {
+        glm::vec3 d = food.pos - sim.getSnakePos();
+        d.y = 0.f;
+        float d2 = glm::dot(d, d);
+        if (d2 < best) { best = d2; to = d; }
+    }
+    if (glm::length(to) > 0.001f) input.moveDir = glm::normalize(to);
+
+    // hop every 90 ticks so the jump / landing path gets exercised too
+    input.jump = (sim.getStats().ticks % 90) == 0;
+    return input;
+}
+
+BatchResult BatchRunner::run() {
+    ThreadPool pool(m_config.threads);
+
+    const uint64_t total = m_config.ticks;
+    const uint64_t slice = uint64_t(m_config.ticksPerTask);
+
+    // one slice of one arena; queues the next slice for the same arena
+    std::function<void(int, uint64_t)> runSlice = [&](int arena, uint64_t done) {
+        ArenaSim &sim = *m_arenas[arena];
+        uint64_t end = std::min(total, done + slice);
+        for (uint64_t t = done; t < end; ++t) {
+            sim.step(m_config.dt, botInput(sim));
+        }
+        if (end < total) {
+            pool.submit([&runSlice, arena, end] { runSlice(arena, end); });
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < m_config.arenas; ++i) {
+        pool.submit([&runSlice, i] { runSlice(i, 0); });
+    }
+    pool.wait();
+
+    auto stop = std::chrono::steady_clock::now();
+
+    BatchResult result;
+    result.threads = pool.size();
+    result.seconds = std::chrono::duration<double>(stop - start).count();
+    for (const auto &sim : m_arenas) {
+        const ArenaSim::SimStats &s = sim->getStats();
+        result.totalTicks += s.ticks;
+        result.foodEaten  += s.foodEaten;
+        result.deaths     += s.deaths;
+    }
+    if (result.seconds > 0.0) result.ticksPerSec = double(result.totalTicks) / result.seconds;
+    return result;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "sim/arenasim.h"
+
+struct BatchConfig {
+    int      arenas       = 64;     // independent ArenaSim instances
+    uint64_t ticks        = 36000;  // fixed ticks per arena (10 min of game time)
+    unsigned threads      = 0;      // 0 = hardware_concurrency
+    uint64_t seed         = 1234;   // arena i is built with seed + i
+    int      ticksPerTask = 600;    // ticks one task runs before re-queueing itself
+    int      foodCount    = 1;      // food items kept on each board
+    float    dt           = ArenaSim::FIXED_DT; // tick length; coarser = more game time per tick
+    int      clothEvery   = 1;      // boss cloth steps once per this many ticks
+};
+
+struct BatchResult {
+    uint64_t totalTicks    = 0;
+    double   seconds       = 0.0;
+    double   ticksPerSec   = 0.0;
+    uint64_t foodEaten     = 0;
+    uint64_t deaths        = 0;
+    unsigned threads       = 0;
+};
+
+/**
+ * BatchRunner - runs many headless arenas at once on a ThreadPool
+ *
+ * Each arena is stepped in slices of ticksPerTask; a slice re-submits the
+ * next one for the same arena, so arenas stay on one worker unless an idle
+ * worker steals them. Arenas are driven by a simple bot that chases food.
+ */
+class BatchRunner {
+public:
+    explicit BatchRunner(const BatchConfig &config);
+
+    BatchResult run();
+
+    const ArenaSim &getArena(int i) const { return *m_arenas[i]; }
+
+    // steer straight at the nearest food, hop every so often
+    static InputFrame botInput(const ArenaSim &sim);
+
+private:
+    BatchConfig m_config;
+    std::vector<std::unique_ptr<ArenaSim>> m_arenas;
+};
@@ -0,0 +1,488 @@
+#include "sim/clothgrid.h"
+#include "sim/threadpool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CLOTHGRID_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+// below this a constraint has no direction and is skipped
+const float MIN_DIST = 1e-6f;
+
+// particles one pool task works through per pass; grids with fewer rows than
+// that (the boss cloth) never leave the calling thread
+const int TASK_PARTICLES = 4096;
+
+// the correction factor both kernels apply: a moves by wa * k * (b - a),
+// b by -wb * k * (b - a). returns false when the constraint is skipped
+inline bool distanceFactor(float dx, float dy, float dz, float wa, float wb,
+                           float rest, float alphaTilde, float &k) {
+    float dist  = std::sqrt(dx * dx + dy * dy + dz * dz);
+    float denom = (wa + wb) + alphaTilde;
+    if (!(denom > 0.0f) || !(dist >= MIN_DIST)) return false;
+    k = (dist - rest) / (denom * dist);
+    return true;
+}
+
+inline void solvePair(const ClothView &v, int a, int b, float rest, float alphaTilde) {
+    float dx = v.x[b] - v.x[a];
+    float dy = v.y[b] - v.y[a];
+    float dz = v.z[b] - v.z[a];
+    float wa = v.invMass[a], wb = v.invMass[b];
+    float k;
+    if (!distanceFactor(dx, dy, dz, wa, wb, rest, alphaTilde, k)) return;
+
+    float ka = wa * k, kb = wb * k;
+    v.x[a] = v.x[a] + ka * dx;  v.y[a] = v.y[a] + ka * dy;  v.z[a] = v.z[a] + ka * dz;
+    v.x[b] = v.x[b] - kb * dx;  v.y[b] = v.y[b] - kb * dy;  v.z[b] = v.z[b] - kb * dz;
+}
+
+#ifdef CLOTHGRID_SSE2
+// four independent constraints, lane i of a to lane i of b; lanes off in
+// mask are left as they are
+inline void project4(__m128 &xa, __m128 &ya, __m128 &za, __m128 wa,
+                     __m128 &xb, __m128 &yb, __m128 &zb, __m128 wb,
+                     __m128 mask, __m128 rest, __m128 alphaTilde) {
+    __m128 dx = _mm_sub_ps(xb, xa), dy = _mm_sub_ps(yb, ya), dz = _mm_sub_ps(zb, za);
+    __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+    __m128 dist  = _mm_sqrt_ps(d2);
+    __m128 denom = _mm_add_ps(_mm_add_ps(wa, wb), alphaTilde);
+
+    mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpgt_ps(denom, _mm_setzero_ps()),
+                                       _mm_cmpge_ps(dist, _mm_set1_ps(MIN_DIST))));
+
+    __m128 k  = _mm_div_ps(_mm_sub_ps(dist, rest), _mm_mul_ps(denom, dist));
+    __m128 ka = _mm_and_ps(mask, _mm_mul_ps(wa, k));
+    __m128 kb = _mm_and_ps(mask, _mm_mul_ps(wb, k));
+
+    xa = _mm_add_ps(xa, _mm_mul_ps(ka, dx)); xb = _mm_sub_ps(xb, _mm_mul_ps(kb, dx));
+    ya = _mm_add_ps(ya, _mm_mul_ps(ka, dy)); yb = _mm_sub_ps(yb, _mm_mul_ps(kb, dy));
+    za = _mm_add_ps(za, _mm_mul_ps(ka, dz)); zb = _mm_sub_ps(zb, _mm_mul_ps(kb, dz));
+}
+
+// lanes whose x (base + offsets) is below limit
+inline __m128 lanesBelow(int base, __m128i offsets, int limit) {
+    return _mm_castsi128_ps(_mm_cmplt_epi32(_mm_add_epi32(_mm_set1_epi32(base), offsets),
+                                            _mm_set1_epi32(limit)));
+}
+#endif
+}
+
+bool ClothSolver::hasSimd() {
+#ifdef CLOTHGRID_SSE2
+    return true;
+#else
+    return false;
+#endif
+}
+
+// --- setup ---
+
+void ClothSolver::initArrays(ClothView &v) {
+    size_t n = size_t(v.stride) * v.height;
+    for (float *a : { v.x, v.y, v.z, v.px, v.py, v.pz, v.vx, v.vy, v.vz, v.nz, v.invMass }) {
+        std::fill(a, a + n, 0.0f);
+    }
+    std::fill(v.nx, v.nx + n, 0.0f);
+    std::fill(v.ny, v.ny + n, 1.0f);
+
+    m_pins.clear();
+    m_time = 0.0f;
+    rebuildPhases(v);
+}
+
+void ClothSolver::rebuildPhases(ClothView &v) {
+    m_phaseX = m_settings.windPhaseX;
+    m_phaseY = m_settings.windPhaseY;
+    for (int y = 0; y < v.height; ++y) {
+        for (int x = 0; x < v.stride; ++x) {
+            float phase = m_phaseX * x + m_phaseY * y;
+            v.sinPhase[y * v.stride + x] = std::sin(phase);
+            v.cosPhase[y * v.stride + x] = std::cos(phase);
+        }
+    }
+}
+
+void ClothSolver::setParticle(ClothView &v, int i, const glm::vec3 &pos, float invMass) {
+    v.x[i]  = pos.x; v.y[i]  = pos.y; v.z[i]  = pos.z;
+    v.px[i] = pos.x; v.py[i] = pos.y; v.pz[i] = pos.z;
+    v.vx[i] = 0.0f;  v.vy[i] = 0.0f;  v.vz[i] = 0.0f;
+    v.invMass[i] = invMass;
+}
+
+void ClothSolver::pinParticle(ClothView &v, int i, const glm::vec3 &pos) {
+    setParticle(v, i, pos, 0.0f);
+    m_pins.push_back({ i, pos, pos });
+}
+
+// --- step ---
+
+void ClothSolver::stepView(ClothView &v, float dt, bool simd, ThreadPool *pool) {
+    if (dt <= 0.0f) return;
+    if (m_settings.windPhaseX != m_phaseX || m_settings.windPhaseY != m_phaseY) rebuildPhases(v);
+
+#ifndef CLOTHGRID_SSE2
+    simd = false;
+#endif
+
+    const int substeps = std::max(m_settings.substeps, 1);
+    const float h = dt / float(substeps);
+    const float invH2 = 1.0f / (h * h);
+    const float stretch = m_settings.stretchCompliance * invH2;
+    const float bend    = m_settings.bendCompliance * invH2;
+    const float restX   = m_settings.restX;
+    const float restY   = m_settings.restY;
+
+    // every pass below touches each particle from one row range only (the
+    // colouring keeps a colour's constraints apart), so splitting rows over
+    // the pool gives the same result as one thread, for any thread count
+    const int grain = std::max(1, TASK_PARTICLES / v.stride);
+    auto forRows = [&](int rows, const std::function<void(int, int)> &fn) {
+        if (!pool || rows <= grain) {
+            fn(0, rows);
+            return;
+        }
+        pool->parallelFor(size_t(rows), size_t(grain),
+                          [&fn](size_t begin, size_t end) { fn(int(begin), int(end)); });
+    };
+
+    for (int s = 0; s < substeps; ++s) {
+        m_time += h;
+        forRows(v.height, [&](int y0, int y1) { predict(v, h, simd, y0, y1); });
+        movePins(v, float(s + 1) / float(substeps));
+
+        // a row pass never leaves its row, so one task can do both colours
+        forRows(v.height, [&](int y0, int y1) {
+            for (int colour = 0; colour < 2; ++colour) solveRows(v, 1, colour, restX, stretch, simd, y0, y1);
+        });
+        // column passes: a task owns the pairs starting in its rows
+        for (int colour = 0; colour < 2; ++colour) {
+            forRows(v.height - 1, [&](int y0, int y1) { solveColumns(v, 1, colour, restY, stretch, simd, y0, y1); });
+        }
+        forRows(v.height, [&](int y0, int y1) {
+            for (int colour = 0; colour < 2; ++colour) solveRows(v, 2, colour, 2.0f * restX, bend, simd, y0, y1);
+        });
+        for (int colour = 0; colour < 2; ++colour) {
+            forRows(v.height - 2, [&](int y0, int y1) { solveColumns(v, 2, colour, 2.0f * restY, bend, simd, y0, y1); });
+        }
+
+        forRows(v.height, [&](int y0, int y1) { finishRows(v, h, simd, y0, y1); });
+
+        // pins: velocity of the anchor, undamped
+        const float invH = 1.0f / h;
+        for (const Pin &pin : m_pins) {
+            int p = pin.index;
+            v.vx[p] = (v.x[p] - v.px[p]) * invH;
+            v.vy[p] = (v.y[p] - v.py[p]) * invH;
+            v.vz[p] = (v.z[p] - v.pz[p]) * invH;
+        }
+    }
+
+    for (Pin &pin : m_pins) pin.from = pin.to;
+
+    forRows(v.height, [&](int y0, int y1) { normalRows(v, simd, y0, y1); });
+}
+
+void ClothSolver::movePins(ClothView &v, float t) {
+    for (const Pin &pin : m_pins) {
+        glm::vec3 p = glm::mix(pin.from, pin.to, t);
+        v.x[pin.index] = p.x; v.y[pin.index] = p.y; v.z[pin.index] = p.z;
+    }
+}
+
+void ClothSolver::predict(ClothView &v, float h, bool simd, int y0, int y1) {
+    const ClothSettings &cs = m_settings;
+    // sin(f t + phase) = sin(f t) cos(phase) + cos(f t) sin(phase)
+    const float sinT = std::sin(cs.windFreq * m_time);
+    const float cosT = std::cos(cs.windFreq * m_time);
+    const glm::vec3 wind = cs.windDir * cs.windStrength;
+    const int n = y1 * v.stride;
+
+    int i = y0 * v.stride;
+#ifdef CLOTHGRID_SSE2
+    if (simd) {
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 vh = _mm_set1_ps(h);
+        const __m128 vsinT = _mm_set1_ps(sinT), vcosT = _mm_set1_ps(cosT);
+        const __m128 gx = _mm_set1_ps(cs.gravity.x), gy = _mm_set1_ps(cs.gravity.y), gz = _mm_set1_ps(cs.gravity.z);
+        const __m128 wx = _mm_set1_ps(wind.x), wy = _mm_set1_ps(wind.y), wz = _mm_set1_ps(wind.z);
+
+        // the stride is a multiple of 4, so this covers every particle
+        for (; i < n; i += 4) {
+            __m128 x = _mm_loadu_ps(v.x + i), y = _mm_loadu_ps(v.y + i), z = _mm_loadu_ps(v.z + i);
+            _mm_storeu_ps(v.px + i, x); _mm_storeu_ps(v.py + i, y); _mm_storeu_ps(v.pz + i, z);
+
+            __m128 w = _mm_loadu_ps(v.invMass + i);
+            __m128 free = _mm_cmpgt_ps(w, zero);
+            if (_mm_movemask_ps(free) == 0) continue;
+
+            __m128 gust = _mm_add_ps(_mm_mul_ps(vsinT, _mm_loadu_ps(v.cosPhase + i)),
+                                     _mm_mul_ps(vcosT, _mm_loadu_ps(v.sinPhase + i)));
+            __m128 windAcc = _mm_mul_ps(gust, w);
+
+            __m128 vx = _mm_loadu_ps(v.vx + i), vy = _mm_loadu_ps(v.vy + i), vz = _mm_loadu_ps(v.vz + i);
+            __m128 nvx = _mm_add_ps(vx, _mm_mul_ps(_mm_add_ps(gx, _mm_mul_ps(wx, windAcc)), vh));
+            __m128 nvy = _mm_add_ps(vy, _mm_mul_ps(_mm_add_ps(gy, _mm_mul_ps(wy, windAcc)), vh));
+            __m128 nvz = _mm_add_ps(vz, _mm_mul_ps(_mm_add_ps(gz, _mm_mul_ps(wz, windAcc)), vh));
+            nvx = _mm_or_ps(_mm_and_ps(free, nvx), _mm_andnot_ps(free, vx));
+            nvy = _mm_or_ps(_mm_and_ps(free, nvy), _mm_andnot_ps(free, vy));
+            nvz = _mm_or_ps(_mm_and_ps(free, nvz), _mm_andnot_ps(free, vz));
+            _mm_storeu_ps(v.vx + i, nvx); _mm_storeu_ps(v.vy + i, nvy); _mm_storeu_ps(v.vz + i, nvz);
+
+            __m128 nx = _mm_add_ps(x, _mm_mul_ps(nvx, vh));
+            __m128 ny = _mm_add_ps(y, _mm_mul_ps(nvy, vh));
+            __m128 nz = _mm_add_ps(z, _mm_mul_ps(nvz, vh));
+            _mm_storeu_ps(v.x + i, _mm_or_ps(_mm_and_ps(free, nx), _mm_andnot_ps(free, x)));
+            _mm_storeu_ps(v.y + i, _mm_or_ps(_mm_and_ps(free, ny), _mm_andnot_ps(free, y)));
+            _mm_storeu_ps(v.z + i, _mm_or_ps(_mm_and_ps(free, nz), _mm_andnot_ps(free, z)));
+        }
+    }
+#endif
+    for (; i < n; ++i) {
+        v.px[i] = v.x[i]; v.py[i] = v.y[i]; v.pz[i] = v.z[i];
+        float w = v.invMass[i];
+        if (!(w > 0.0f)) continue;
+
+        float gust    = sinT * v.cosPhase[i] + cosT * v.sinPhase[i];
+        float windAcc = gust * w;
+        v.vx[i] = v.vx[i] + (cs.gravity.x + wind.x * windAcc) * h;
+        v.vy[i] = v.vy[i] + (cs.gravity.y + wind.y * windAcc) * h;
+        v.vz[i] = v.vz[i] + (cs.gravity.z + wind.z * windAcc) * h;
+        v.x[i] = v.x[i] + v.vx[i] * h;
+        v.y[i] = v.y[i] + v.vy[i] * h;
+        v.z[i] = v.z[i] + v.vz[i] * h;
+    }
+}
+
+void ClothSolver::solveRows(ClothView &v, int step, int colour, float rest, float alphaTilde,
+                            bool simd, int y0, int y1) {
+    const int last = v.width - step;   // pairs start at x < last
+#ifdef CLOTHGRID_SSE2
+    if (simd) {
+        // 8 particles per iteration hold 4 pairs of one colour: for step 1
+        // the even lanes pair with the odd ones, for step 2 lanes 0,1,4,5
+        // with 2,3,6,7. split them apart, solve, interleave back
+        const __m128 vrest = _mm_set1_ps(rest), valpha = _mm_set1_ps(alphaTilde);
+        const __m128i offsets = step == 1 ? _mm_setr_epi32(0, 2, 4, 6) : _mm_setr_epi32(0, 1, 4, 5);
+
+        auto split = [step](const float *p, __m128 &a, __m128 &b) {
+            __m128 lo = _mm_loadu_ps(p), hi = _mm_loadu_ps(p + 4);
+            if (step == 1) {
+                a = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+                b = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+            } else {
+                a = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(1, 0, 1, 0));
+                b = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 2, 3, 2));
+            }
+        };
+        auto join = [step](float *p, __m128 a, __m128 b) {
+            if (step == 1) {
+                _mm_storeu_ps(p,     _mm_unpacklo_ps(a, b));
+                _mm_storeu_ps(p + 4, _mm_unpackhi_ps(a, b));
+            } else {
+                _mm_storeu_ps(p,     _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 1, 0)));
+                _mm_storeu_ps(p + 4, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 2, 3, 2)));
+            }
+        };
+
+        for (int y = y0; y < y1; ++y) {
+            int row = y * v.stride;
+            for (int x = colour * step; x < last; x += 8) {
+                int i = row + x;
+                __m128 xa, xb, ya, yb, za, zb, wa, wb;
+                split(v.x + i, xa, xb);
+                split(v.y + i, ya, yb);
+                split(v.z + i, za, zb);
+                split(v.invMass + i, wa, wb);
+
+                project4(xa, ya, za, wa, xb, yb, zb, wb, lanesBelow(x, offsets, last), vrest, valpha);
+
+                join(v.x + i, xa, xb);
+                join(v.y + i, ya, yb);
+                join(v.z + i, za, zb);
+            }
+        }
+        return;
+    }
+#endif
+    for (int y = y0; y < y1; ++y) {
+        int row = y * v.stride;
+        for (int x = 0; x < last; ++x) {
+            if ((x / step) % 2 != colour) continue;
+            solvePair(v, row + x, row + x + step, rest, alphaTilde);
+        }
+    }
+}
+
+void ClothSolver::solveColumns(ClothView &v, int step, int colour, float rest, float alphaTilde,
+                               bool simd, int y0, int y1) {
+    y1 = std::min(y1, v.height - step);
+#ifdef CLOTHGRID_SSE2
+    if (simd) {
+        const __m128 vrest = _mm_set1_ps(rest), valpha = _mm_set1_ps(alphaTilde);
+        const __m128i offsets = _mm_setr_epi32(0, 1, 2, 3);
+        for (int y = y0; y < y1; ++y) {
+            if ((y / step) % 2 != colour) continue;
+            int a = y * v.stride, b = (y + step) * v.stride;
+            for (int x = 0; x < v.width; x += 4) {
+                __m128 xa = _mm_loadu_ps(v.x + a + x), ya = _mm_loadu_ps(v.y + a + x), za = _mm_loadu_ps(v.z + a + x);
+                __m128 xb = _mm_loadu_ps(v.x + b + x), yb = _mm_loadu_ps(v.y + b + x), zb = _mm_loadu_ps(v.z + b + x);
+
+                project4(xa, ya, za, _mm_loadu_ps(v.invMass + a + x),
+                         xb, yb, zb, _mm_loadu_ps(v.invMass + b + x),
+                         lanesBelow(x, offsets, v.width), vrest, valpha);
+
+                _mm_storeu_ps(v.x + a + x, xa); _mm_storeu_ps(v.y + a + x, ya); _mm_storeu_ps(v.z + a + x, za);
+                _mm_storeu_ps(v.x + b + x, xb); _mm_storeu_ps(v.y + b + x, yb); _mm_storeu_ps(v.z + b + x, zb);
+            }
+        }
+        return;
+    }
+#endif
+    for (int y = y0; y < y1; ++y) {
+        if ((y / step) % 2 != colour) continue;
+        int a = y * v.stride, b = (y + step) * v.stride;
+        for (int x = 0; x < v.width; ++x) solvePair(v, a + x, b + x, rest, alphaTilde);
+    }
+}
+
+void ClothSolver::finishRows(ClothView &v, float h, bool simd, int y0, int y1) {
+    const ClothSettings &cs = m_settings;
+    const float velScale = 1.0f / (h * (1.0f + cs.damping * h));
+    const float r  = cs.sphereRadius;
+    const float r2 = r * r;
+    const glm::vec3 c = cs.sphereCenter;
+    const int n = y1 * v.stride;
+
+    int i = y0 * v.stride;
+#ifdef CLOTHGRID_SSE2
+    if (simd) {
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 vr = _mm_set1_ps(r), vr2 = _mm_set1_ps(r2), eps = _mm_set1_ps(1e-8f);
+        const __m128 cx = _mm_set1_ps(c.x), cy = _mm_set1_ps(c.y), cz = _mm_set1_ps(c.z);
+        const __m128 floorY = _mm_set1_ps(cs.floorY);
+        const __m128 vscale = _mm_set1_ps(velScale);
+
+        for (; i < n; i += 4) {
+            __m128 free = _mm_cmpgt_ps(_mm_loadu_ps(v.invMass + i), zero);
+            if (_mm_movemask_ps(free) == 0) continue;
+
+            __m128 x = _mm_loadu_ps(v.x + i), y = _mm_loadu_ps(v.y + i), z = _mm_loadu_ps(v.z + i);
+
+            // head sphere: push back out to the surface
+            __m128 dx = _mm_sub_ps(x, cx), dy = _mm_sub_ps(y, cy), dz = _mm_sub_ps(z, cz);
+            __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+            __m128 inside = _mm_and_ps(free, _mm_cmplt_ps(d2, vr2));
+            if (_mm_movemask_ps(inside) != 0) {
+                __m128 scale = _mm_div_ps(vr, _mm_sqrt_ps(_mm_add_ps(d2, eps)));
+                x = _mm_or_ps(_mm_and_ps(inside, _mm_add_ps(cx, _mm_mul_ps(dx, scale))), _mm_andnot_ps(inside, x));
+                y = _mm_or_ps(_mm_and_ps(inside, _mm_add_ps(cy, _mm_mul_ps(dy, scale))), _mm_andnot_ps(inside, y));
+                z = _mm_or_ps(_mm_and_ps(inside, _mm_add_ps(cz, _mm_mul_ps(dz, scale))), _mm_andnot_ps(inside, z));
+            }
+
+            // floor
+            __m128 below = _mm_and_ps(free, _mm_cmplt_ps(y, floorY));
+            y = _mm_or_ps(_mm_and_ps(below, floorY), _mm_andnot_ps(below, y));
+
+            _mm_storeu_ps(v.x + i, x); _mm_storeu_ps(v.y + i, y); _mm_storeu_ps(v.z + i, z);
+
+            __m128 vx = _mm_mul_ps(_mm_sub_ps(x, _mm_loadu_ps(v.px + i)), vscale);
+            __m128 vy = _mm_mul_ps(_mm_sub_ps(y, _mm_loadu_ps(v.py + i)), vscale);
+            __m128 vz = _mm_mul_ps(_mm_sub_ps(z, _mm_loadu_ps(v.pz + i)), vscale);
+            _mm_storeu_ps(v.vx + i, _mm_or_ps(_mm_and_ps(free, vx), _mm_andnot_ps(free, _mm_loadu_ps(v.vx + i))));
+            _mm_storeu_ps(v.vy + i, _mm_or_ps(_mm_and_ps(free, vy), _mm_andnot_ps(free, _mm_loadu_ps(v.vy + i))));
+            _mm_storeu_ps(v.vz + i, _mm_or_ps(_mm_and_ps(free, vz), _mm_andnot_ps(free, _mm_loadu_ps(v.vz + i))));
+        }
+    }
+#endif
+    for (; i < n; ++i) {
+        if (!(v.invMass[i] > 0.0f)) continue;
+
+        float dx = v.x[i] - c.x, dy = v.y[i] - c.y, dz = v.z[i] - c.z;
+        float d2 = dx * dx + dy * dy + dz * dz;
+        if (d2 < r2) {
+            float scale = r / std::sqrt(d2 + 1e-8f);
+            v.x[i] = c.x + dx * scale;
+            v.y[i] = c.y + dy * scale;
+            v.z[i] = c.z + dz * scale;
+        }
+        if (v.y[i] < cs.floorY) v.y[i] = cs.floorY;
+
+        v.vx[i] = (v.x[i] - v.px[i]) * velScale;
+        v.vy[i] = (v.y[i] - v.py[i]) * velScale;
+        v.vz[i] = (v.z[i] - v.pz[i]) * velScale;
+    }
+}
+
+// --- normals ---
+
+namespace {
+// tx = right - left along the row, ty = down - up along the column
+inline void storeNormal(const ClothView &v, int i, float tx, float ty, float tz,
+                        float ux, float uy, float uz) {
+    float nx = ty * uz - tz * uy;
+    float ny = tz * ux - tx * uz;
+    float nz = tx * uy - ty * ux;
+    float len2 = nx * nx + ny * ny + nz * nz;
+    if (len2 > 1e-12f) {
+        float inv = 1.0f / std::sqrt(len2);
+        v.nx[i] = nx * inv; v.ny[i] = ny * inv; v.nz[i] = nz * inv;
+    } else {
+        v.nx[i] = 0.0f; v.ny[i] = 1.0f; v.nz[i] = 0.0f;
+    }
+}
+
+inline void normalAt(const ClothView &v, int x, int up, int row, int down) {
+    int l = row + (x > 0 ? x - 1 : x);
+    int r = row + (x < v.width - 1 ? x + 1 : x);
+    storeNormal(v, row + x,
+                v.x[r] - v.x[l], v.y[r] - v.y[l], v.z[r] - v.z[l],
+                v.x[down + x] - v.x[up + x], v.y[down + x] - v.y[up + x], v.z[down + x] - v.z[up + x]);
+}
+}
+
+void ClothSolver::normalRows(ClothView &v, bool simd, int y0, int y1) {
+#ifndef CLOTHGRID_SSE2
+    simd = false;
+#endif
+    for (int y = y0; y < y1; ++y) {
+        int row  = y * v.stride;
+        int up   = (y > 0 ? y - 1 : y) * v.stride;
+        int down = (y < v.height - 1 ? y + 1 : y) * v.stride;
+
+        // edges take one-sided differences, so only the interior is vectorized
+        normalAt(v, 0, up, row, down);
+        int x = 1;
+#ifdef CLOTHGRID_SSE2
+        if (simd) {
+            const __m128 tiny = _mm_set1_ps(1e-12f), one = _mm_set1_ps(1.0f);
+            for (; x + 4 <= v.width - 1; x += 4) {
+                int i = row + x;
+                __m128 tx = _mm_sub_ps(_mm_loadu_ps(v.x + i + 1), _mm_loadu_ps(v.x + i - 1));
+                __m128 ty = _mm_sub_ps(_mm_loadu_ps(v.y + i + 1), _mm_loadu_ps(v.y + i - 1));
+                __m128 tz = _mm_sub_ps(_mm_loadu_ps(v.z + i + 1), _mm_loadu_ps(v.z + i - 1));
+                __m128 ux = _mm_sub_ps(_mm_loadu_ps(v.x + down + x), _mm_loadu_ps(v.x + up + x));
+                __m128 uy = _mm_sub_ps(_mm_loadu_ps(v.y + down + x), _mm_loadu_ps(v.y + up + x));
+                __m128 uz = _mm_sub_ps(_mm_loadu_ps(v.z + down + x), _mm_loadu_ps(v.z + up + x));
+
+                __m128 nx = _mm_sub_ps(_mm_mul_ps(ty, uz), _mm_mul_ps(tz, uy));
+                __m128 ny = _mm_sub_ps(_mm_mul_ps(tz, ux), _mm_mul_ps(tx, uz));
+                __m128 nz = _mm_sub_ps(_mm_mul_ps(tx, uy), _mm_mul_ps(ty, ux));
+                __m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny)), _mm_mul_ps(nz, nz));
+                __m128 ok  = _mm_cmpgt_ps(len2, tiny);
+                __m128 inv = _mm_div_ps(one, _mm_sqrt_ps(len2));
+
+                _mm_storeu_ps(v.nx + i, _mm_and_ps(ok, _mm_mul_ps(nx, inv)));
+                _mm_storeu_ps(v.ny + i, _mm_or_ps(_mm_and_ps(ok, _mm_mul_ps(ny, inv)), _mm_andnot_ps(ok, one)));
+                _mm_storeu_ps(v.nz + i, _mm_and_ps(ok, _mm_mul_ps(nz, inv)));
+            }
+        }
+#endif
+        for (; x < v.width; ++x) normalAt(v, x, up, row, down);
+    }
+}
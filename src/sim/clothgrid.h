@@ -0,0 +1,223 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <array>
+#include <type_traits>
+#include <vector>
+
+class ThreadPool;
+
+/**
+ * ClothGrid - XPBD cloth on a width x height particle grid, structure-of-arrays
+ *
+ * Positions, the positions at the start of the substep, velocities and
+ * inverse masses each live in their own float array, one padded row after
+ * another (getStride() floats per row, a multiple of 4 with room for the
+ * kernels to read a few lanes past the last column). A particle with inverse
+ * mass 0 doesn't move on its own: pinned particles, and the padding.
+ *
+ * Each step(dt) runs settings.substeps substeps of
+ *   1. predict: gravity + a travelling wind gust, explicit integration
+ *   2. distance constraints to the direct neighbours (stretch) and to the
+ *      particle two over (bending), rows then columns, each family split in
+ *      two colours so no two constraints of one colour share a particle
+ *   3. sphere + floor collision, velocities from the motion, damping
+ * Pins move linearly from where they were to their target over the substeps.
+ * After the last substep a normals pass leaves a unit vertex normal per
+ * particle (cross of the central differences along x and y), ready for the
+ * renderer to stream as is. GpuCloth runs the same passes, in the same
+ * order, as transform feedback passes.
+ *
+ * Given a ThreadPool, each pass is split into row ranges run in parallel.
+ * Inside a pass no particle is touched from two ranges, so the result is
+ * the same bit for bit whatever the thread count (or no pool at all).
+ *
+ * ClothGrid<W, H> keeps its arrays inline; ClothGrid<> (ClothGrid<DYNAMIC,
+ * DYNAMIC>) takes the size at construction and keeps them on the heap. Both
+ * run the same ClothSolver passes, which use SSE2 (4 particles / constraints
+ * per iteration) where available and the scalar loop elsewhere; both give
+ * identical results.
+ */
+struct ClothSettings {
+    float restX = 1.0f;               // rest spacing between columns
+    float restY = 1.0f;               // and between rows
+    float stretchCompliance = 0.0f;   // 1 / stiffness; 0 = rigid
+    float bendCompliance    = 0.0f;
+    float damping = 0.0f;             // velocity decay per second
+
+    int substeps = 4;
+
+    glm::vec3 gravity = glm::vec3(0.0f, -9.8f, 0.0f);
+
+    // gust = sin(windFreq * t + windPhaseX * x + windPhaseY * y), force along windDir
+    glm::vec3 windDir = glm::vec3(1.0f, 0.0f, 0.0f);
+    float windStrength = 0.0f;
+    float windFreq     = 2.0f;
+    float windPhaseX   = 0.0f;
+    float windPhaseY   = 0.0f;
+
+    glm::vec3 sphereCenter = glm::vec3(0.0f);
+    float sphereRadius = 0.0f;        // 0 = no sphere
+    float floorY = -1e30f;
+};
+
+// the arrays of one grid, as the solver sees them
+struct ClothView {
+    int width = 0, height = 0, stride = 0;
+    float *x, *y, *z;        // positions
+    float *px, *py, *pz;     // positions at the start of the substep
+    float *vx, *vy, *vz;
+    float *nx, *ny, *nz;     // vertex normals, as of the last step
+    float *invMass;
+    float *sinPhase, *cosPhase;   // wind phase per particle
+};
+
+class ClothSolver {
+public:
+    static constexpr int DYNAMIC = 0;
+
+    struct Pin {
+        int index;
+        glm::vec3 from, to;   // where it was at the last step, where it's headed
+    };
+
+    ClothSettings &settings() { return m_settings; }
+    const ClothSettings &settings() const { return m_settings; }
+
+    float getTime() const { return m_time; }
+    const std::vector<Pin> &getPins() const { return m_pins; }
+    void setPinTarget(int pin, const glm::vec3 &target) { m_pins[pin].to = target; }
+
+    static bool hasSimd();
+
+protected:
+    // rows are padded to a multiple of 4, plus 8 so the row kernel's
+    // 8-wide loads near the end of a row stay inside it
+    static constexpr int paddedStride(int width) { return ((width + 3) & ~3) + 8; }
+
+    void initArrays(ClothView &v);   // zeroes everything, builds the wind phases
+    void setParticle(ClothView &v, int i, const glm::vec3 &pos, float invMass);
+    void pinParticle(ClothView &v, int i, const glm::vec3 &pos);
+
+    void stepView(ClothView &v, float dt, bool simd, ThreadPool *pool);
+    void normalRows(ClothView &v, bool simd, int y0, int y1);
+
+private:
+    // each pass covers rows [y0, y1); column passes the pairs starting there
+    void rebuildPhases(ClothView &v);
+    void predict(ClothView &v, float h, bool simd, int y0, int y1);
+    void movePins(ClothView &v, float t);
+    void solveRows(ClothView &v, int step, int colour, float rest, float alphaTilde,
+                   bool simd, int y0, int y1);
+    void solveColumns(ClothView &v, int step, int colour, float rest, float alphaTilde,
+                      bool simd, int y0, int y1);
+    void finishRows(ClothView &v, float h, bool simd, int y0, int y1);
+
+    ClothSettings m_settings;
+    std::vector<Pin> m_pins;
+    float m_time = 0.0f;
+    float m_phaseX = 0.0f, m_phaseY = 0.0f;   // settings the phase arrays were built for
+};
+
+template <int W = ClothSolver::DYNAMIC, int H = ClothSolver::DYNAMIC>
+class ClothGrid : public ClothSolver {
+public:
+    static constexpr bool IS_DYNAMIC = (W == DYNAMIC || H == DYNAMIC);
+
+    ClothGrid() requires(!IS_DYNAMIC) { allocate(W, H); }
+    ClothGrid(int width, int height) requires(IS_DYNAMIC) { allocate(width, height); }
+
+    int getWidth() const  { if constexpr (IS_DYNAMIC) return m_width;  else return W; }
+    int getHeight() const { if constexpr (IS_DYNAMIC) return m_height; else return H; }
+    int getStride() const { if constexpr (IS_DYNAMIC) return m_stride; else return STRIDE; }
+
+    int index(int x, int y) const { return y * getStride() + x; }
+
+    // every particle back to the origin at rest, no pins, time 0; keeps settings()
+    void reset() { ClothView v = view(); initArrays(v); }
+
+    glm::vec3 getPos(int x, int y) const {
+        int i = index(x, y);
+        return glm::vec3(m_x[i], m_y[i], m_z[i]);
+    }
+    glm::vec3 getVel(int x, int y) const {
+        int i = index(x, y);
+        return glm::vec3(m_vx[i], m_vy[i], m_vz[i]);
+    }
+    glm::vec3 getNormal(int x, int y) const {
+        int i = index(x, y);
+        return glm::vec3(m_nx[i], m_ny[i], m_nz[i]);
+    }
+    float getInvMass(int x, int y) const { return m_invMass[index(x, y)]; }
+
+    // step() keeps normals current; call this after placing particles by hand
+    void updateNormals() {
+        ClothView v = view();
+        normalRows(v, hasSimd(), 0, getHeight());
+    }
+
+    // puts a particle at pos, at rest, free (invMass > 0) or static (0)
+    void setParticle(int x, int y, const glm::vec3 &pos, float invMass = 1.0f) {
+        ClothView v = view();
+        ClothSolver::setParticle(v, index(x, y), pos, invMass);
+    }
+
+    // pins a particle; every step moves it to the pin's target
+    void pin(int x, int y, const glm::vec3 &pos) {
+        ClothView v = view();
+        pinParticle(v, index(x, y), pos);
+    }
+
+    // pool (optional) runs the passes in parallel; same result without it
+    void step(float dt, ThreadPool *pool = nullptr) {
+        ClothView v = view();
+        stepView(v, dt, hasSimd(), pool);
+    }
+
+    // the two kernels behind step(), public for benchmarking
+    void stepScalar(float dt, ThreadPool *pool = nullptr) { ClothView v = view(); stepView(v, dt, false, pool); }
+    void stepSimd(float dt, ThreadPool *pool = nullptr)   { ClothView v = view(); stepView(v, dt, true, pool); }
+
+private:
+    static constexpr int STRIDE = IS_DYNAMIC ? 0 : paddedStride(W);
+    static constexpr size_t COUNT = IS_DYNAMIC ? 0 : size_t(STRIDE) * H;
+
+    using Array = std::conditional_t<IS_DYNAMIC, std::vector<float>, std::array<float, COUNT>>;
+
+    void allocate(int width, int height) {
+        if constexpr (IS_DYNAMIC) {
+            m_width  = glm::max(width, 1);
+            m_height = glm::max(height, 1);
+            m_stride = paddedStride(m_width);
+            size_t n = size_t(m_stride) * m_height;
+            for (Array *a : { &m_x, &m_y, &m_z, &m_px, &m_py, &m_pz, &m_vx, &m_vy, &m_vz,
+                              &m_nx, &m_ny, &m_nz, &m_invMass, &m_sinPhase, &m_cosPhase }) {
+                a->assign(n, 0.0f);
+            }
+        }
+        ClothView v = view();
+        initArrays(v);
+    }
+
+    ClothView view() {
+        ClothView v;
+        v.width = getWidth(); v.height = getHeight(); v.stride = getStride();
+        v.x  = m_x.data();  v.y  = m_y.data();  v.z  = m_z.data();
+        v.px = m_px.data(); v.py = m_py.data(); v.pz = m_pz.data();
+        v.vx = m_vx.data(); v.vy = m_vy.data(); v.vz = m_vz.data();
+        v.nx = m_nx.data(); v.ny = m_ny.data(); v.nz = m_nz.data();
+        v.invMass  = m_invMass.data();
+        v.sinPhase = m_sinPhase.data();
+        v.cosPhase = m_cosPhase.data();
+        return v;
+    }
+
+    int m_width = 0, m_height = 0, m_stride = 0;   // DYNAMIC only
+
+    Array m_x, m_y, m_z;
+    Array m_px, m_py, m_pz;
+    Array m_vx, m_vy, m_vz;
+    Array m_nx, m_ny, m_nz;
+    Array m_invMass;
+    Array m_sinPhase, m_cosPhase;
+};
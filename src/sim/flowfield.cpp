@@ -0,0 +1,100 @@
+#include "sim/flowfield.h"
+#include "sim/gridcoords.h"
+
+namespace {
+const int DX[4] = { 1, -1, 0,  0 };
+const int DZ[4] = { 0,  0, 1, -1 };
+}
+
+bool FlowField::setTarget(const OccupancyGrid &grid, int tx, int tz) {
+    const bool sameSize = grid.getWidth() == m_width && grid.getHeight() == m_height;
+    if (m_valid && sameSize && tx == m_tx && tz == m_tz) return false;
+
+    if (!sameSize) {
+        m_width  = grid.getWidth();
+        m_height = grid.getHeight();
+        m_dist.resize(size_t(m_width) * m_height);
+        m_step.resize(size_t(m_width) * m_height);
+        m_queue.reserve(size_t(m_width) * m_height);
+    }
+
+    m_tx = tx;
+    m_tz = tz;
+    m_valid = true;
+
+    std::fill(m_dist.begin(), m_dist.end(), -1);
+    std::fill(m_step.begin(), m_step.end(), NO_STEP);
+    if (!grid.inBounds(tx, tz)) return true;
+
+    // BFS outward from the target; a cell reached from c steps back toward c.
+    // A wall target (snake jumping over one) is never a step: its free
+    // neighbours become the targets instead
+    m_queue.clear();
+    if (!grid.test(tx, tz)) {
+        m_queue.push_back(tz * m_width + tx);
+    } else {
+        for (int k = 0; k < 4; ++k) {
+            int nx = tx + DX[k], nz = tz + DZ[k];
+            if (grid.inBounds(nx, nz) && !grid.test(nx, nz)) m_queue.push_back(nz * m_width + nx);
+        }
+    }
+    for (int c : m_queue) m_dist[c] = 0;
+
+    for (size_t head = 0; head < m_queue.size(); ++head) {
+        int c  = m_queue[head];
+        int cx = c % m_width, cz = c / m_width;
+
+        for (int k = 0; k < 4; ++k) {
+            int nx = cx + DX[k], nz = cz + DZ[k];
+            if (!grid.inBounds(nx, nz) || grid.test(nx, nz)) continue;
+
+            int n = nz * m_width + nx;
+            if (m_dist[n] >= 0) continue;
+
+            m_dist[n] = m_dist[c] + 1;
+            m_step[n] = uint8_t(k ^ 1);   // opposite offset leads back to c
+            m_queue.push_back(n);
+        }
+    }
+    return true;
+}
+
+int FlowField::distance(int gx, int gz) const {
+    if (!m_valid || gx < 0 || gx >= m_width || gz < 0 || gz >= m_height) return -1;
+    return m_dist[gz * m_width + gx];
+}
+
+bool FlowField::nextCell(int gx, int gz, int &nx, int &nz) const {
+    if (!m_valid || gx < 0 || gx >= m_width || gz < 0 || gz >= m_height) return false;
+
+    uint8_t k = m_step[gz * m_width + gx];
+    if (k == NO_STEP) return false;
+
+    nx = gx + DX[k];
+    nz = gz + DZ[k];
+    return true;
+}
+
+bool FlowField::nextWaypoint(const glm::vec3 &pos, glm::vec3 &out) const {
+    const int gx = GridCoords::toCell(pos.x), gz = GridCoords::toCell(pos.z);
+    int nx, nz;
+    if (!nextCell(gx, gz, nx, nz)) {
+        // stuck in a wall or a cell the BFS never reached: back out to the
+        // reached neighbour closest to the target
+        if (distance(gx, gz) >= 0) return false;
+
+        int best = -1;
+        for (int k = 0; k < 4; ++k) {
+            int d = distance(gx + DX[k], gz + DZ[k]);
+            if (d >= 0 && (best < 0 || d < best)) {
+                best = d;
+                nx = gx + DX[k];
+                nz = gz + DZ[k];
+            }
+        }
+        if (best < 0) return false;
+    }
+
+    out = glm::vec3(GridCoords::cellCenter(nx), pos.y, GridCoords::cellCenter(nz));
+    return true;
+}
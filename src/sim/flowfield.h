@@ -0,0 +1,55 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "sim/occupancygrid.h"
+
+/**
+ * FlowField - BFS distance field toward one target cell on the maze grid
+ *
+ * setTarget() reruns the BFS only when the target cell actually changes
+ * (or after invalidate()), and every reached cell stores the neighbour one
+ * step closer to the target. Any number of chasers can then look up their
+ * next cell in O(1) from one shared field.
+ *
+ * Movement is 4-connected (no diagonal corner cutting past walls). The
+ * field takes its size from the grid it was last computed on. A target on
+ * a wall cell is swapped for its free neighbours, so no path leads into a
+ * wall.
+ */
+class FlowField {
+public:
+    FlowField() = default;
+
+    // maze changed: the next setTarget() recomputes even for the same cell
+    void invalidate() { m_valid = false; }
+
+    // returns true if the field was recomputed
+    bool setTarget(const OccupancyGrid &grid, int tx, int tz);
+
+    // BFS steps from (gx, gz) to the target, -1 if unreachable / off grid
+    int distance(int gx, int gz) const;
+
+    // neighbour one step closer to the target. false if unreachable, off
+    // grid, or already at the target
+    bool nextCell(int gx, int gz, int &nx, int &nz) const;
+
+    // world-space point a chaser at pos should head for next: the centre of
+    // the next cell on the path (GridCoords::cellCenter), y copied from pos.
+    // From a wall or unreached cell, the nearest reached neighbour instead.
+    // false at the target or with nowhere to go
+    bool nextWaypoint(const glm::vec3 &pos, glm::vec3 &out) const;
+
+private:
+    static constexpr uint8_t NO_STEP = 0xff;
+
+    std::vector<int32_t> m_dist;   // row-major z * m_width + x
+    std::vector<uint8_t> m_step;   // index into the 4 neighbour offsets
+    std::vector<int32_t> m_queue;  // BFS frontier, reused between runs
+
+    int  m_width = 0, m_height = 0;
+    int  m_tx = -1, m_tz = -1;
+    bool m_valid = false;
+};
@@ -0,0 +1,57 @@
+#include "sim/freecellindex.h"
+#include <algorithm>
+
+void FreeCellIndex::reset(const OccupancyGrid &maze, int x0, int z0, int x1, int z1) {
+    m_width = maze.getWidth();
+    const int cells = maze.getWidth() * maze.getHeight();
+
+    m_free.clear();
+    m_free.reserve(cells);
+    m_slot.assign(cells, -1);
+    m_blocks.assign(cells, 0);
+    m_walkable.assign(cells, 0);
+
+    x0 = std::max(x0, 0);
+    z0 = std::max(z0, 0);
+    x1 = std::min(x1, maze.getWidth() - 1);
+    z1 = std::min(z1, maze.getHeight() - 1);
+
+    for (int z = z0; z <= z1; ++z) {
+        for (int x = x0; x <= x1; ++x) {
+            if (maze.test(x, z)) continue;
+            int cell = z * m_width + x;
+            m_walkable[cell] = 1;
+            insert(cell);
+        }
+    }
+}
+
+void FreeCellIndex::insert(int cell) {
+    m_slot[cell] = (int32_t)m_free.size();
+    m_free.push_back(cell);
+}
+
+void FreeCellIndex::erase(int cell) {
+    // swap the last free cell into this one's slot
+    int32_t slot = m_slot[cell];
+    int32_t last = m_free.back();
+    m_free[slot] = last;
+    m_slot[last] = slot;
+    m_free.pop_back();
+    m_slot[cell] = -1;
+}
+
+void FreeCellIndex::block(int cell) {
+    if (cell < 0 || cell >= (int)m_blocks.size()) return;
+    if (m_blocks[cell]++ == 0 && m_walkable[cell]) erase(cell);
+}
+
+void FreeCellIndex::unblock(int cell) {
+    if (cell < 0 || cell >= (int)m_blocks.size() || m_blocks[cell] == 0) return;
+    if (--m_blocks[cell] == 0 && m_walkable[cell]) insert(cell);
+}
+
+int FreeCellIndex::pick(SimRandom &rng) const {
+    if (m_free.empty()) return -1;
+    return m_free[rng.nextInt((int)m_free.size())];
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "sim/occupancygrid.h"
+#include "sim/simrandom.h"
+
+/**
+ * FreeCellIndex - the set of cells something can be spawned on
+ *
+ * A cell is free when it is walkable (inside the spawn region, not a wall)
+ * and nothing currently blocks it. Free cells live in a dense array with a
+ * per-cell slot back-pointer, so block / unblock are swap-removes and a
+ * uniform random pick is one draw, however full the board gets.
+ *
+ * Blocks are reference counted: several body segments (or a segment and a
+ * food item) can sit on one cell, and it only frees up when all have left.
+ * Cell ids are row-major z * width + x on the maze grid.
+ */
+class FreeCellIndex {
+public:
+    // walkable = inside [x0,x1] x [z0,z1] (inclusive, clipped) and not set
+    // in maze. clears every block
+    void reset(const OccupancyGrid &maze, int x0, int z0, int x1, int z1);
+
+    void block(int cell);
+    void unblock(int cell);
+
+    int getNumFree() const { return (int)m_free.size(); }
+    bool isFree(int cell) const { return m_slot[cell] >= 0; }
+
+    // uniform over the free cells, -1 if there are none
+    int pick(SimRandom &rng) const;
+
+    int getWidth() const { return m_width; }
+
+private:
+    void insert(int cell);
+    void erase(int cell);
+
+    int m_width = 0;
+    std::vector<int32_t>  m_free;      // dense list of free cell ids
+    std::vector<int32_t>  m_slot;      // index into m_free, -1 if not free
+    std::vector<uint16_t> m_blocks;    // blockers per cell
+    std::vector<uint8_t>  m_walkable;
+};
@@ -0,0 +1,89 @@
+#include "sim/ghostcloth.h"
+
+GhostCloth::GhostCloth() {
+    ClothSettings &s = m_grid.settings();
+    s.restX = m_restLenX;
+    s.restY = m_restLenZ;
+    s.stretchCompliance = 1.0f / 25.0f;   // same give as the old k = 25 springs
+    s.bendCompliance    = 0.5f;           // across two particles, keeps it from creasing
+    s.damping  = 1.1f;
+    s.substeps = 4;
+
+    // wind for ghosty wobble, phase running across the sheet
+    s.windDir      = glm::normalize(glm::vec3(1.0f, 0.1f, 0.7f));
+    s.windStrength = 0.6f;
+    s.windFreq     = 2.0f;
+    s.windPhaseX   = 0.8f;
+    s.windPhaseY   = 1.3f;
+
+    s.sphereRadius = m_radius;
+    s.floorY = 0.0f;
+
+    init(glm::vec3(0.0f));
+}
+
+void GhostCloth::init(const glm::vec3 &bossPos) {
+    m_grid.reset();
+
+    glm::vec3 headCenter = bossPos + m_offset;
+    m_grid.settings().sphereCenter = headCenter;
+
+    float width  = (W - 1) * m_restLenX;  // ~7.65
+    float depth  = (H - 1) * m_restLenZ;  // ~1.4
+    float xStart = -0.5f * width;
+    float zStart = -0.5f * depth;
+
+    for (int y = 0; y < H; ++y) {
+        for (int x = 0; x < W; ++x) {
+            float px = xStart + x * m_restLenX;
+            float pz = zStart + y * m_restLenZ;
+
+            // start slightly above the sphere so it falls onto it; the
+            // collar slides to its anchors on the first update
+            glm::vec3 pos = headCenter + glm::vec3(px, 1.3f * m_radius, pz);
+            if (isPinned(x, y)) m_grid.pin(x, y, pos);
+            else                m_grid.setParticle(x, y, pos);
+        }
+    }
+    m_grid.updateNormals();
+}
+
+bool GhostCloth::isPinned(int x, int y) {
+    // Only pin the center chunk of the top row
+    if (y != 0) return false;
+
+    int center = W / 2;
+    int halfSpan = 2; // pin ~5 points total: center-2 .. center+2
+    int left  = center - halfSpan;
+    int right = center + halfSpan;
+
+    return (x >= left && x <= right);
+}
+
+void GhostCloth::setCompliance(float stretch, float bend) {
+    m_grid.settings().stretchCompliance = glm::max(stretch, 0.0f);
+    m_grid.settings().bendCompliance    = glm::max(bend, 0.0f);
+}
+
+glm::vec3 GhostCloth::anchorFor(int x, const glm::vec3 &bossPos) const {
+    float width  = (W - 1) * m_restLenX;
+    float xStart = -0.5f * width;
+
+    // base “shoulder” height and offset
+    float baseY = 1.7f;   // tweak a bit if needed
+    float baseZ = -0.15f; // slightly behind boss center
+
+    float px = xStart + x * m_restLenX;
+
+    // small vertical arc so it's not perfectly straight
+    int center   = W / 2;
+    float dxNorm = float(x - center) / float(W / 2);
+    float hump   = 0.12f * (1.0f - dxNorm * dxNorm); // max in middle, less at sides
+
+    return bossPos + glm::vec3(px, baseY + hump, baseZ);
+}
+
+void GhostCloth::update(float dt, const glm::vec3 &bossPos) {
+    aim(m_grid, bossPos);
+    m_grid.step(dt);
+}
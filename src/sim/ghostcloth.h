@@ -0,0 +1,62 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "sim/clothgrid.h"
+
+// Cloth "hair" sheet that hangs off the boss cube.
+// Pure simulation: no GL, the renderer reads particle positions back out.
+//
+// A ClothGrid<W, H> (substepped XPBD, see clothgrid.h) with the centre of
+// the top row pinned to a collar on the boss, a head sphere to drape over
+// and a gusting wind. Stable for any dt, so the sim may tick it less often
+// than itself.
+class GhostCloth {
+public:
+    static const int W = 18;   // wider
+    static const int H = 6;    // grid height
+
+    GhostCloth();
+
+    void init(const glm::vec3 &bossPos);
+    void update(float dt, const glm::vec3 &bossPos);
+
+    // points a cloth at the boss: head sphere, collar pin targets. Works on
+    // anything with settings() and setPinTarget() set up from getGrid()
+    // (the grid itself, or a GpuCloth), so another solver can follow this one
+    template <typename Cloth>
+    void aim(Cloth &cloth, const glm::vec3 &bossPos) const {
+        cloth.settings().sphereCenter = bossPos + m_offset;
+
+        // pins were added left to right along the top row
+        int pin = 0;
+        for (int x = 0; x < W; ++x) {
+            if (isPinned(x, 0)) cloth.setPinTarget(pin++, anchorFor(x, bossPos));
+        }
+    }
+
+    // row-major particle index, as used for the renderer's copy
+    static int index(int x, int y) { return y * W + x; }
+    static bool isPinned(int x, int y);
+
+    glm::vec3 getPos(int x, int y) const { return m_grid.getPos(x, y); }
+    glm::vec3 getNormal(int x, int y) const { return m_grid.getNormal(x, y); }
+    const ClothGrid<W, H> &getGrid() const { return m_grid; }
+
+    void setSubsteps(int n) { m_grid.settings().substeps = glm::max(n, 1); }
+    int getSubsteps() const { return m_grid.settings().substeps; }
+
+    // compliance = 1 / stiffness; 0 is a rigid constraint
+    void setCompliance(float stretch, float bend);
+
+private:
+    glm::vec3 anchorFor(int x, const glm::vec3 &bossPos) const;
+
+    float m_restLenX = 0.45f;   // spacing left–right
+    float m_restLenZ = 0.28f;   // spacing front–back
+
+    glm::vec3 m_offset = glm::vec3(0.0f, 1.2f, 0.0f); // tweak 1.0–1.4 to taste
+    float     m_radius = 1.6f;                        // invisible head sphere
+
+    ClothGrid<W, H> m_grid;
+};
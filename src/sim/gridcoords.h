@@ -0,0 +1,41 @@
+#pragma once
+
+#include <algorithm>
+
+// World <-> arena grid cell mapping shared by everything that buckets the
+// arena floor (maze occupancy, boss chase, spatial hash). The grid is
+// GRID_SIZE x GRID_SIZE cells of GRID_SCALE units centered on the origin.
+namespace GridCoords {
+
+constexpr int   GRID_SIZE  = 60;
+constexpr float GRID_SCALE = 1.0f;
+
+// same truncating mapping the gameplay code has always used
+inline int toCell(float world) {
+    return int(world / GRID_SCALE) + GRID_SIZE / 2;
+}
+
+// a point inside cell c on either side of the origin (its integer corner
+// nearest the origin), so steering toward it always enters that cell
+inline float toWorld(int cell) {
+    return float(cell - GRID_SIZE / 2) * GRID_SCALE;
+}
+
+// middle of the world-space span that maps to cell c (the centre cell is
+// twice as wide, since truncation sends (-1, 1) to it)
+inline float cellCenter(int cell) {
+    if (cell == GRID_SIZE / 2) return 0.f;
+    float half = (cell > GRID_SIZE / 2) ? 0.5f : -0.5f;
+    return (float(cell - GRID_SIZE / 2) + half) * GRID_SCALE;
+}
+
+inline bool inBounds(int gx, int gz) {
+    return gx >= 0 && gx < GRID_SIZE && gz >= 0 && gz < GRID_SIZE;
+}
+
+// for bucketing: anything off the grid lands in the nearest border cell
+inline int toCellClamped(float world) {
+    return std::clamp(toCell(world), 0, GRID_SIZE - 1);
+}
+
+}
@@ -0,0 +1,146 @@
+#include "sim/inputrecording.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace {
+const char     MAGIC[4] = { 'A', 'R', 'P', 'L' };
+const uint32_t VERSION  = 1;
+
+// fixed-size little-endian fields; every platform we build on is LE
+template <typename T>
+void put(std::ofstream &out, const T &v) {
+    out.write(reinterpret_cast<const char *>(&v), sizeof(T));
+}
+
+template <typename T>
+bool get(std::ifstream &in, T &v) {
+    return bool(in.read(reinterpret_cast<char *>(&v), sizeof(T)));
+}
+
+bool fail(std::string *error, const std::string &msg) {
+    if (error) *error = msg;
+    return false;
+}
+}
+
+void InputRecording::begin(uint64_t seed, float dt, int foodCount, int bouncingLights) {
+    m_seed      = seed;
+    m_dt        = dt;
+    m_foodCount = foodCount;
+    m_bouncingLights = bouncingLights;
+    m_numTicks  = 0;
+    m_finalHash = 0;
+    m_runs.clear();
+}
+
+void InputRecording::record(const InputFrame &input, bool playing) {
+    Run frame { 1, input.moveDir.x, input.moveDir.z,
+                uint8_t((input.jump ? FLAG_JUMP : 0) | (playing ? FLAG_PLAYING : 0)) };
+
+    m_numTicks++;
+    if (!m_runs.empty()) {
+        Run &last = m_runs.back();
+        // compare bit patterns so -0 / +0 (and any NaN) replay exactly
+        if (last.flags == frame.flags && last.length < UINT32_MAX &&
+            std::memcmp(&last.moveX, &frame.moveX, sizeof(float)) == 0 &&
+            std::memcmp(&last.moveZ, &frame.moveZ, sizeof(float)) == 0) {
+            last.length++;
+            return;
+        }
+    }
+    m_runs.push_back(frame);
+}
+
+void InputRecording::setupArena(ArenaSim &sim) const {
+    sim.setBouncingLightCount(m_bouncingLights);
+    sim.buildArena(m_seed);
+    sim.setFoodCount(m_foodCount);
+}
+
+void InputRecording::replay(ArenaSim &sim) const {
+    setupArena(sim);
+
+    InputFrame input;
+    for (const Run &run : m_runs) {
+        input.moveDir = glm::vec3(run.moveX, 0.f, run.moveZ);
+        input.jump    = (run.flags & FLAG_JUMP) != 0;
+        sim.setPlaying((run.flags & FLAG_PLAYING) != 0);
+
+        for (uint32_t i = 0; i < run.length; ++i) {
+            sim.step(m_dt, input);
+        }
+    }
+}
+
+bool InputRecording::Cursor::next(InputFrame &input, bool &playing) {
+    const std::vector<Run> &runs = m_recording.m_runs;
+    while (m_run < runs.size() && m_tick >= runs[m_run].length) {
+        ++m_run;
+        m_tick = 0;
+    }
+    if (m_run >= runs.size()) return false;
+
+    const Run &run = runs[m_run];
+    input.moveDir = glm::vec3(run.moveX, 0.f, run.moveZ);
+    input.jump    = (run.flags & FLAG_JUMP) != 0;
+    playing       = (run.flags & FLAG_PLAYING) != 0;
+    ++m_tick;
+    return true;
+}
+
+bool InputRecording::save(const std::string &path, std::string *error) const {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return fail(error, "cannot open " + path + " for writing");
+
+    out.write(MAGIC, 4);
+    put(out, VERSION);
+    put(out, m_seed);
+    put(out, m_dt);
+    put(out, m_foodCount);
+    put(out, m_bouncingLights);
+    put(out, m_numTicks);
+    put(out, m_finalHash);
+    put(out, uint32_t(m_runs.size()));
+    for (const Run &run : m_runs) {
+        put(out, run.length);
+        put(out, run.moveX);
+        put(out, run.moveZ);
+        put(out, run.flags);
+    }
+
+    if (!out) return fail(error, "write failed: " + path);
+    return true;
+}
+
+bool InputRecording::load(const std::string &path, std::string *error) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return fail(error, "cannot open " + path);
+
+    char magic[4];
+    uint32_t version = 0, numRuns = 0;
+    if (!in.read(magic, 4) || std::memcmp(magic, MAGIC, 4) != 0) {
+        return fail(error, path + " is not an arena recording");
+    }
+    if (!get(in, version) || version != VERSION) {
+        return fail(error, path + ": unsupported recording version");
+    }
+
+    bool ok = get(in, m_seed) && get(in, m_dt) && get(in, m_foodCount) &&
+              get(in, m_bouncingLights) && get(in, m_numTicks) && get(in, m_finalHash) && get(in, numRuns);
+    if (!ok) return fail(error, path + ": truncated header");
+
+    m_runs.clear();
+    m_runs.reserve(numRuns);
+    uint64_t ticks = 0;
+    for (uint32_t i = 0; i < numRuns; ++i) {
+        Run run;
+        if (!(get(in, run.length) && get(in, run.moveX) && get(in, run.moveZ) && get(in, run.flags))) {
+            return fail(error, path + ": truncated input runs");
+        }
+        ticks += run.length;
+        m_runs.push_back(run);
+    }
+    if (ticks != m_numTicks) return fail(error, path + ": tick count does not match runs");
+    return true;
+}
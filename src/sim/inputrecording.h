@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "sim/arenasim.h"
+
+/**
+ * InputRecording - everything needed to replay an arena session exactly
+ *
+ * The arena seed, tick length, food and bouncing light counts, plus the
+ * input every step() saw, run-length encoded (held keys repeat the same
+ * frame for many ticks).
+ * finalHash is ArenaSim::computeStateHash() at the end of the session, so a
+ * replay can be checked bit-for-bit.
+ *
+ * File layout (little-endian):
+ *   "ARPL" u32 version | u64 seed | f32 dt | i32 foodCount |
+ *   i32 bouncingLights | u64 numTicks | u64 finalHash | u32 numRuns |
+ *   numRuns x { u32 length | f32 moveX | f32 moveZ | u8 flags }
+ */
+class InputRecording {
+public:
+    struct Run {
+        uint32_t length;
+        float    moveX;
+        float    moveZ;
+        uint8_t  flags;   // FLAG_*
+    };
+
+    static constexpr uint8_t FLAG_JUMP    = 1;
+    static constexpr uint8_t FLAG_PLAYING = 2;
+
+    // start an empty recording for an arena built with these settings
+    void begin(uint64_t seed, float dt, int foodCount, int bouncingLights = 80);
+
+    // called by ArenaSim::step() for every tick
+    void record(const InputFrame &input, bool playing);
+
+    void setFinalHash(uint64_t hash) { m_finalHash = hash; }
+
+    uint64_t getSeed() const { return m_seed; }
+    float getDt() const { return m_dt; }
+    int getFoodCount() const { return m_foodCount; }
+    int getBouncingLights() const { return m_bouncingLights; }
+    uint64_t getNumTicks() const { return m_numTicks; }
+    uint64_t getFinalHash() const { return m_finalHash; }
+    const std::vector<Run> &getRuns() const { return m_runs; }
+
+    // build a fresh arena from the header and step it through every
+    // recorded tick as fast as possible
+    void replay(ArenaSim &sim) const;
+
+    // the arena replay() starts from, without stepping it
+    void setupArena(ArenaSim &sim) const;
+
+    // walks the recorded ticks one at a time, for callers that step the
+    // sim themselves (e.g. the offscreen renderer)
+    class Cursor {
+    public:
+        explicit Cursor(const InputRecording &recording) : m_recording(recording) {}
+
+        // input and playing flag for the next tick; false when all are used
+        bool next(InputFrame &input, bool &playing);
+
+    private:
+        const InputRecording &m_recording;
+        size_t   m_run  = 0;
+        uint32_t m_tick = 0;   // within m_run
+    };
+
+    // false (with a message in error) on I/O or format problems
+    bool save(const std::string &path, std::string *error = nullptr) const;
+    bool load(const std::string &path, std::string *error = nullptr);
+
+private:
+    uint64_t m_seed      = 0;
+    float    m_dt        = ArenaSim::FIXED_DT;
+    int32_t  m_foodCount = 1;
+    int32_t  m_bouncingLights = 80;
+    uint64_t m_numTicks  = 0;
+    uint64_t m_finalHash = 0;
+    std::vector<Run> m_runs;
+};
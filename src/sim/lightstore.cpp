@@ -0,0 +1,234 @@
+#include "sim/lightstore.h"
+#include "sim/gridcoords.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LIGHTSTORE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+using namespace GridCoords;
+
+void LightStore::clear() {
+    m_numStatic = 0;
+    m_x.clear(); m_y.clear(); m_z.clear();
+    m_vx.clear(); m_vz.clear();
+    m_gx.clear(); m_gz.clear();
+    m_inWall.clear();
+    m_color.clear();
+}
+
+void LightStore::addStatic(const glm::vec3 &pos, const glm::vec3 &color) {
+    // keep statics in front of the bouncing range
+    m_x.insert(m_x.begin() + m_numStatic, pos.x);
+    m_y.insert(m_y.begin() + m_numStatic, pos.y);
+    m_z.insert(m_z.begin() + m_numStatic, pos.z);
+    m_vx.insert(m_vx.begin() + m_numStatic, 0.f);
+    m_vz.insert(m_vz.begin() + m_numStatic, 0.f);
+    m_gx.insert(m_gx.begin() + m_numStatic, toCell(pos.x));
+    m_gz.insert(m_gz.begin() + m_numStatic, toCell(pos.z));
+    m_inWall.insert(m_inWall.begin() + m_numStatic, WALL_NO);
+    m_color.insert(m_color.begin() + m_numStatic, color);
+    m_numStatic++;
+}
+
+void LightStore::resetWallCache() {
+    std::fill(m_inWall.begin() + m_numStatic, m_inWall.end(), WALL_UNKNOWN);
+}
+
+void LightStore::addBouncing(const glm::vec3 &pos, const glm::vec3 &vel, const glm::vec3 &color) {
+    m_x.push_back(pos.x);
+    m_y.push_back(pos.y);
+    m_z.push_back(pos.z);
+    m_vx.push_back(vel.x);
+    m_vz.push_back(vel.z);
+    m_gx.push_back(toCell(pos.x));
+    m_gz.push_back(toCell(pos.z));
+    m_inWall.push_back(WALL_UNKNOWN);
+    m_color.push_back(color);
+}
+
+void LightStore::refreshCell(int i, const OccupancyGrid &maze) {
+    m_gx[i] = toCell(m_x[i]);
+    m_gz[i] = toCell(m_z[i]);
+    m_inWall[i] = maze.test(m_gx[i], m_gz[i]) ? WALL_YES : WALL_NO;
+}
+
+bool LightStore::hasSimd() {
+#ifdef LIGHTSTORE_SSE2
+    return true;
+#else
+    return false;
+#endif
+}
+
+void LightStore::update(float dt, const OccupancyGrid &maze, float arenaBounds) {
+#ifdef LIGHTSTORE_SSE2
+    updateSimd(dt, maze, arenaBounds);
+#else
+    updateScalar(dt, maze, arenaBounds);
+#endif
+}
+
+void LightStore::updateScalar(float dt, const OccupancyGrid &maze, float arenaBounds) {
+    updateRangeScalar(m_numStatic, size(), dt, maze, arenaBounds);
+}
+
+void LightStore::updateRangeScalar(int begin, int end, float dt,
+                                   const OccupancyGrid &maze, float arenaBounds) {
+    for (int i = begin; i < end; ++i) {
+        float nx = m_x[i] + m_vx[i] * dt;
+        float nz = m_z[i] + m_vz[i] * dt;
+
+        bool hit = false;
+        if (std::abs(nx) > arenaBounds) { m_vx[i] = -m_vx[i]; hit = true; }
+        if (std::abs(nz) > arenaBounds) { m_vz[i] = -m_vz[i]; hit = true; }
+
+        int gx = 0, gz = 0;
+        if (!hit) {
+            gx = toCell(nx); gz = toCell(nz);
+            int prevGx = m_gx[i], prevGz = m_gz[i];
+
+            // still in the same cell: reuse what we know about it
+            bool sameCell = (gx == prevGx && gz == prevGz && m_inWall[i] != WALL_UNKNOWN);
+            bool wall = sameCell ? (m_inWall[i] == WALL_YES) : maze.test(gx, gz);
+
+            if (wall) {
+                // flip whichever axis crossed into the wall cell
+                if (gx != prevGx)      m_vx[i] = -m_vx[i];
+                else if (gz != prevGz) m_vz[i] = -m_vz[i];
+                else { m_vx[i] = -m_vx[i]; m_vz[i] = -m_vz[i]; }
+                hit = true;
+            }
+        }
+
+        if (!hit) {
+            m_x[i] = nx;
+            m_z[i] = nz;
+            m_gx[i] = gx;
+            m_gz[i] = gz;
+            m_inWall[i] = WALL_NO;   // just checked, or the same cell as before
+        } else {
+            m_x[i] += m_vx[i] * dt;
+            m_z[i] += m_vz[i] * dt;
+            refreshCell(i, maze);
+        }
+    }
+}
+
+#ifdef LIGHTSTORE_SSE2
+
+void LightStore::updateSimd(float dt, const OccupancyGrid &maze, float arenaBounds) {
+    const __m128 vdt     = _mm_set1_ps(dt);
+    const __m128 vbounds = _mm_set1_ps(arenaBounds);
+    const __m128 vscale  = _mm_set1_ps(GRID_SCALE);
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    const __m128i half   = _mm_set1_epi32(GRID_SIZE / 2);
+    const __m128  allOnes = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    const __m128i zero    = _mm_setzero_si128();
+    const __m128i yes     = _mm_set1_epi32(WALL_YES);
+    const __m128i unknown = _mm_set1_epi32(WALL_UNKNOWN);
+
+    const int end = size();
+    int i = m_numStatic;
+
+    for (; i + 4 <= end; i += 4) {
+        __m128 x  = _mm_loadu_ps(&m_x[i]);
+        __m128 z  = _mm_loadu_ps(&m_z[i]);
+        __m128 vx = _mm_loadu_ps(&m_vx[i]);
+        __m128 vz = _mm_loadu_ps(&m_vz[i]);
+
+        __m128 nx = _mm_add_ps(x, _mm_mul_ps(vx, vdt));
+        __m128 nz = _mm_add_ps(z, _mm_mul_ps(vz, vdt));
+
+        // arena bounds: |n| > bounds flips that axis
+        __m128 outX = _mm_cmpgt_ps(_mm_andnot_ps(signBit, nx), vbounds);
+        __m128 outZ = _mm_cmpgt_ps(_mm_andnot_ps(signBit, nz), vbounds);
+        __m128 flipX = outX;
+        __m128 flipZ = outZ;
+        __m128 hit   = _mm_or_ps(outX, outZ);
+
+        // maze cells, for the lanes that didn't already bounce
+        if (_mm_movemask_ps(hit) != 0xf) {
+            // truncating convert matches GridCoords::toCell; the previous
+            // cell is already stored
+            __m128i gx  = _mm_add_epi32(_mm_cvttps_epi32(_mm_div_ps(nx, vscale)), half);
+            __m128i gz  = _mm_add_epi32(_mm_cvttps_epi32(_mm_div_ps(nz, vscale)), half);
+            __m128i pgx = _mm_loadu_si128((const __m128i *)&m_gx[i]);
+            __m128i pgz = _mm_loadu_si128((const __m128i *)&m_gz[i]);
+
+            __m128 movedX = _mm_xor_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(gx, pgx)), allOnes);
+            __m128 movedZ = _mm_xor_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(gz, pgz)), allOnes);
+            __m128 stayX  = _mm_xor_ps(movedX, allOnes);
+
+            // lanes still in a cell we already know about skip the lookup
+            int flags;
+            std::memcpy(&flags, &m_inWall[i], 4);
+            __m128i f = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(flags), zero), zero);
+            __m128 known  = _mm_andnot_ps(_mm_or_ps(movedX, movedZ),
+                                          _mm_xor_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(f, unknown)), allOnes));
+            __m128 cached = _mm_and_ps(known, _mm_castsi128_ps(_mm_cmpeq_epi32(f, yes)));
+
+            // the rest is a gather from the bit grid. when any lane needs it,
+            // look up all four branch-free and mask, rather than branching per lane
+            __m128 needLanes = _mm_andnot_ps(_mm_or_ps(hit, known), allOnes);
+            __m128 looked = _mm_setzero_ps();
+            if (_mm_movemask_ps(needLanes)) {
+                alignas(16) int cx[4], cz[4];
+                _mm_store_si128((__m128i *)cx, gx);
+                _mm_store_si128((__m128i *)cz, gz);
+                auto lane = [&](int k) { return -int(maze.testBranchless(cx[k], cz[k])); };
+                looked = _mm_and_ps(needLanes, _mm_castsi128_ps(
+                    _mm_set_epi32(lane(3), lane(2), lane(1), lane(0))));
+            }
+            __m128 wallMask = _mm_andnot_ps(hit, _mm_or_ps(cached, looked));
+
+            // gx changed -> flip x; else gz changed -> flip z; else flip both
+            __m128 wx = _mm_and_ps(wallMask, _mm_or_ps(movedX, _mm_andnot_ps(movedZ, stayX)));
+            __m128 wz = _mm_and_ps(wallMask, stayX);
+
+            flipX = _mm_or_ps(flipX, wx);
+            flipZ = _mm_or_ps(flipZ, wz);
+            hit   = _mm_or_ps(hit, wallMask);
+
+            // bounced lanes are overwritten below
+            _mm_storeu_si128((__m128i *)&m_gx[i], gx);
+            _mm_storeu_si128((__m128i *)&m_gz[i], gz);
+        }
+
+        vx = _mm_xor_ps(vx, _mm_and_ps(flipX, signBit));
+        vz = _mm_xor_ps(vz, _mm_and_ps(flipZ, signBit));
+
+        // no hit: take the predicted position; hit: step with the new velocity
+        __m128 bx = _mm_add_ps(x, _mm_mul_ps(vx, vdt));
+        __m128 bz = _mm_add_ps(z, _mm_mul_ps(vz, vdt));
+        x = _mm_or_ps(_mm_and_ps(hit, bx), _mm_andnot_ps(hit, nx));
+        z = _mm_or_ps(_mm_and_ps(hit, bz), _mm_andnot_ps(hit, nz));
+
+        _mm_storeu_ps(&m_x[i], x);
+        _mm_storeu_ps(&m_z[i], z);
+        _mm_storeu_ps(&m_vx[i], vx);
+        _mm_storeu_ps(&m_vz[i], vz);
+
+        // a lane that moved normally just saw its cell was clear; a bounced
+        // lane ended up somewhere unchecked (rare, so look it up directly)
+        std::memset(&m_inWall[i], WALL_NO, 4);
+        if (int bounceBits = _mm_movemask_ps(hit)) {
+            for (int k = 0; k < 4; ++k) {
+                if (bounceBits & (1 << k)) refreshCell(i + k, maze);
+            }
+        }
+    }
+
+    updateRangeScalar(i, end, dt, maze, arenaBounds);
+}
+
+#else
+
+void LightStore::updateSimd(float dt, const OccupancyGrid &maze, float arenaBounds) {
+    updateScalar(dt, maze, arenaBounds);
+}
+
+#endif
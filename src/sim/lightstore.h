@@ -0,0 +1,67 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "sim/occupancygrid.h"
+
+/**
+ * LightStore - arena point lights in structure-of-arrays form
+ *
+ * Static lights (portal glows) are kept at the front, bouncing lights after
+ * them, so the physics kernel runs over one contiguous range of plain float
+ * arrays. Velocities are in units per second and update() takes dt.
+ *
+ * Each light also remembers its current cell and whether that cell is a
+ * wall, so only the new position is converted to a cell and a light that
+ * stays inside one cell (most of them, most ticks) skips the maze lookup.
+ * Call resetWallCache() if the maze changes under existing lights.
+ *
+ * update() uses an SSE2 kernel (4 lights per iteration) where available and
+ * falls back to the scalar loop elsewhere; both give identical results. The
+ * kernel is barely faster: light_bench measures about 1.1x over the scalar
+ * loop at 4096 lights, since the wall lookups stay a per-lane gather.
+ */
+class LightStore {
+public:
+    void clear();
+
+    void addStatic(const glm::vec3 &pos, const glm::vec3 &color);
+    void addBouncing(const glm::vec3 &pos, const glm::vec3 &vel, const glm::vec3 &color);
+
+    void resetWallCache();
+
+    int size() const { return (int)m_x.size(); }
+    int getNumStatic() const { return m_numStatic; }
+    bool isStatic(int i) const { return i < m_numStatic; }
+
+    glm::vec3 getPos(int i) const { return glm::vec3(m_x[i], m_y[i], m_z[i]); }
+    glm::vec3 getVel(int i) const { return glm::vec3(m_vx[i], 0.f, m_vz[i]); }
+    const glm::vec3 &getColor(int i) const { return m_color[i]; }
+
+    // move bouncing lights by dt, reflecting off the square arena bounds
+    // (|x|, |z| <= arenaBounds) and off occupied maze cells
+    void update(float dt, const OccupancyGrid &maze, float arenaBounds);
+
+    // the two kernels behind update(), public for benchmarking
+    void updateScalar(float dt, const OccupancyGrid &maze, float arenaBounds);
+    void updateSimd(float dt, const OccupancyGrid &maze, float arenaBounds);
+    static bool hasSimd();
+
+private:
+    void updateRangeScalar(int begin, int end, float dt,
+                           const OccupancyGrid &maze, float arenaBounds);
+    // recompute light i's cell and wall flag from its position
+    void refreshCell(int i, const OccupancyGrid &maze);
+
+    enum : uint8_t { WALL_NO = 0, WALL_YES = 1, WALL_UNKNOWN = 2 };
+
+    int m_numStatic = 0;
+
+    std::vector<float> m_x, m_y, m_z;
+    std::vector<float> m_vx, m_vz;   // units / second, 0 for static lights
+    std::vector<int> m_gx, m_gz;     // the light's current cell
+    std::vector<uint8_t> m_inWall;   // is the light's current cell a wall
+    std::vector<glm::vec3> m_color;
+};
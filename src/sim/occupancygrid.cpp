@@ -0,0 +1,121 @@
+#include "sim/occupancygrid.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+void OccupancyGrid::reset(int width, int height) {
+    m_width  = std::max(width, 0);
+    m_height = std::max(height, 0);
+    m_wordsPerRow = (m_width + 63) / 64;
+    m_bits.assign(size_t(m_wordsPerRow) * m_height, 0);
+}
+
+void OccupancyGrid::set(int x, int z, bool occupied) {
+    if (!inBounds(x, z)) return;
+    uint64_t &w = m_bits[size_t(z) * m_wordsPerRow + (x >> 6)];
+    uint64_t bit = uint64_t(1) << (x & 63);
+    if (occupied) w |= bit;
+    else          w &= ~bit;
+}
+
+uint64_t OccupancyGrid::spanMask(int lo, int hi) {
+    lo &= 63;
+    hi &= 63;
+    uint64_t upTo = (hi == 63) ? ~uint64_t(0) : ((uint64_t(1) << (hi + 1)) - 1);
+    return upTo & (~uint64_t(0) << lo);
+}
+
+bool OccupancyGrid::clip(int &x0, int &z0, int &x1, int &z1) const {
+    if (x0 > x1) std::swap(x0, x1);
+    if (z0 > z1) std::swap(z0, z1);
+    x0 = std::max(x0, 0);
+    z0 = std::max(z0, 0);
+    x1 = std::min(x1, m_width - 1);
+    z1 = std::min(z1, m_height - 1);
+    return x0 <= x1 && z0 <= z1;
+}
+
+void OccupancyGrid::fillRect(int x0, int z0, int x1, int z1, bool occupied) {
+    if (!clip(x0, z0, x1, z1)) return;
+
+    for (int z = z0; z <= z1; ++z) {
+        uint64_t *row = &m_bits[size_t(z) * m_wordsPerRow];
+        for (int w = x0 >> 6; w <= (x1 >> 6); ++w) {
+            int lo = std::max(x0, w * 64);
+            int hi = std::min(x1, w * 64 + 63);
+            uint64_t mask = spanMask(lo, hi);
+            if (occupied) row[w] |= mask;
+            else          row[w] &= ~mask;
+        }
+    }
+}
+
+bool OccupancyGrid::anyInRect(int x0, int z0, int x1, int z1) const {
+    if (!clip(x0, z0, x1, z1)) return false;
+
+    for (int z = z0; z <= z1; ++z) {
+        const uint64_t *row = &m_bits[size_t(z) * m_wordsPerRow];
+        for (int w = x0 >> 6; w <= (x1 >> 6); ++w) {
+            int lo = std::max(x0, w * 64);
+            int hi = std::min(x1, w * 64 + 63);
+            if (row[w] & spanMask(lo, hi)) return true;
+        }
+    }
+    return false;
+}
+
+int OccupancyGrid::countInRect(int x0, int z0, int x1, int z1) const {
+    if (!clip(x0, z0, x1, z1)) return 0;
+
+    int count = 0;
+    for (int z = z0; z <= z1; ++z) {
+        const uint64_t *row = &m_bits[size_t(z) * m_wordsPerRow];
+        for (int w = x0 >> 6; w <= (x1 >> 6); ++w) {
+            int lo = std::max(x0, w * 64);
+            int hi = std::min(x1, w * 64 + 63);
+            count += std::popcount(row[w] & spanMask(lo, hi));
+        }
+    }
+    return count;
+}
+
+bool OccupancyGrid::raycast(float x0, float z0, float x1, float z1,
+                            int &hitX, int &hitZ, float &hitT) const {
+    const float inf = std::numeric_limits<float>::infinity();
+    const float dx = x1 - x0, dz = z1 - z0;
+
+    int cx = int(std::floor(x0)), cz = int(std::floor(z0));
+    const int endX = int(std::floor(x1)), endZ = int(std::floor(z1));
+
+    const int stepX = (dx > 0.f) ? 1 : -1;
+    const int stepZ = (dz > 0.f) ? 1 : -1;
+
+    // t to cross one whole cell, and t of the first boundary on each axis
+    const float tDeltaX = (dx != 0.f) ? std::abs(1.f / dx) : inf;
+    const float tDeltaZ = (dz != 0.f) ? std::abs(1.f / dz) : inf;
+    float tMaxX = (dx != 0.f) ? ((stepX > 0 ? (cx + 1 - x0) : (x0 - cx)) * tDeltaX) : inf;
+    float tMaxZ = (dz != 0.f) ? ((stepZ > 0 ? (cz + 1 - z0) : (z0 - cz)) * tDeltaZ) : inf;
+
+    float t = 0.f;
+    const int maxSteps = std::abs(endX - cx) + std::abs(endZ - cz) + 1;
+    for (int i = 0; i < maxSteps; ++i) {
+        if (test(cx, cz)) {
+            hitX = cx;
+            hitZ = cz;
+            hitT = std::min(t, 1.f);
+            return true;
+        }
+        if (tMaxX < tMaxZ) {
+            t = tMaxX;
+            tMaxX += tDeltaX;
+            cx += stepX;
+        } else {
+            t = tMaxZ;
+            tMaxZ += tDeltaZ;
+            cz += stepZ;
+        }
+        if (t > 1.f) break;
+    }
+    return false;
+}
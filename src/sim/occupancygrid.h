@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * OccupancyGrid - one bit per cell, row-major (index = z * width + x)
+ *
+ * Each row is padded to whole 64-bit words so rectangle queries can test a
+ * row a word at a time. Cells outside the grid read as empty.
+ *
+ * 60x60 is 480 bytes; 4096x4096 is 2 MB.
+ */
+class OccupancyGrid {
+public:
+    OccupancyGrid() = default;
+    OccupancyGrid(int width, int height) { reset(width, height); }
+
+    // resize and clear every cell
+    void reset(int width, int height);
+
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+    size_t getMemoryBytes() const { return m_bits.size() * sizeof(uint64_t); }
+
+    bool inBounds(int x, int z) const {
+        return x >= 0 && x < m_width && z >= 0 && z < m_height;
+    }
+
+    bool test(int x, int z) const {
+        if (!inBounds(x, z)) return false;
+        return (word(x, z) >> (x & 63)) & 1u;
+    }
+
+    // same as test() but without data-dependent branches, for SIMD-style
+    // loops where the cell coordinates are effectively random
+    bool testBranchless(int x, int z) const {
+        const bool in = (unsigned(x) < unsigned(m_width)) & (unsigned(z) < unsigned(m_height));
+        const int cx = in ? x : 0, cz = in ? z : 0;
+        return in & bool((m_bits[size_t(cz) * m_wordsPerRow + (cx >> 6)] >> (cx & 63)) & 1u);
+    }
+
+    void set(int x, int z, bool occupied = true);
+
+    // --- rectangles, inclusive corners, clipped to the grid ---
+    void fillRect(int x0, int z0, int x1, int z1, bool occupied = true);
+    bool anyInRect(int x0, int z0, int x1, int z1) const;
+    int  countInRect(int x0, int z0, int x1, int z1) const;
+
+    // --- ray / DDA ---
+    // walks the cells under the segment (x0,z0)->(x1,z1) in continuous cell
+    // coordinates (cell (i,j) covers [i,i+1) x [j,j+1)), in order. stops at
+    // the first occupied cell: returns true with that cell and the segment
+    // parameter t in [0,1] where the segment enters it
+    bool raycast(float x0, float z0, float x1, float z1,
+                 int &hitX, int &hitZ, float &hitT) const;
+
+private:
+    uint64_t word(int x, int z) const { return m_bits[size_t(z) * m_wordsPerRow + (x >> 6)]; }
+
+    // bits [lo, hi] of the word holding column lo..hi (same word)
+    static uint64_t spanMask(int lo, int hi);
+
+    bool clip(int &x0, int &z0, int &x1, int &z1) const;
+
+    int m_width  = 0;
+    int m_height = 0;
+    int m_wordsPerRow = 0;
+    std::vector<uint64_t> m_bits;
+};
@@ -0,0 +1,85 @@
+#include "sim/rendersnapshot.h"
+
+#include <algorithm>
+
+void RenderSnapshot::capture(const ArenaSim &sim) {
+    tick = sim.getStats().ticks;
+
+    snakePos        = sim.getSnakePos();
+    snakeJumpOffset = sim.getSnakeJumpOffset();
+    deathProgress   = sim.getDeathProgress();
+    body.assign(sim.getSnakeBody().begin(), sim.getSnakeBody().end());
+
+    food.assign(sim.getFood().begin(), sim.getFood().end());
+
+    bossActive    = sim.isBossActive();
+    bossPos       = sim.getBossPos();
+    bossPulseTime = sim.getBossPulseTime();
+    cloth.clear();
+    clothNormals.clear();
+    if (bossActive) {
+        const GhostCloth &ghost = sim.getGhostCloth();
+        for (int y = 0; y < GhostCloth::H; ++y) {
+            for (int x = 0; x < GhostCloth::W; ++x) {
+                cloth.push_back(ghost.getPos(x, y));
+                clothNormals.push_back(ghost.getNormal(x, y));
+            }
+        }
+    }
+
+    const LightStore &lights = sim.getLights();
+    lightPos.resize(lights.size());
+    lightColor.resize(lights.size());
+    for (int i = 0; i < lights.size(); ++i) {
+        lightPos[i]   = lights.getPos(i);
+        lightColor[i] = lights.getColor(i);
+    }
+}
+
+static glm::vec3 blend(const glm::vec3 &a, const glm::vec3 &b, float t) {
+    glm::vec3 d = b - a;
+    if (glm::dot(d, d) > RenderSnapshot::SNAP_DISTANCE * RenderSnapshot::SNAP_DISTANCE) return b;
+    return a + d * t;
+}
+
+// element-wise blend where both have the element, b's value elsewhere
+static void blendAll(const std::vector<glm::vec3> &a, const std::vector<glm::vec3> &b,
+                     float t, std::vector<glm::vec3> &out) {
+    out.resize(b.size());
+    const size_t n = std::min(a.size(), b.size());
+    for (size_t i = 0; i < n; ++i) out[i] = blend(a[i], b[i], t);
+    for (size_t i = n; i < b.size(); ++i) out[i] = b[i];
+}
+
+void RenderSnapshot::interpolate(const RenderSnapshot &a, const RenderSnapshot &b, float alpha) {
+    const float t = glm::clamp(alpha, 0.f, 1.f);
+
+    tick = b.tick;
+
+    snakePos        = blend(a.snakePos, b.snakePos, t);
+    snakeJumpOffset = glm::mix(a.snakeJumpOffset, b.snakeJumpOffset, t);
+    // death restarts from 0 on a new death; don't blend across that
+    deathProgress   = b.deathProgress >= a.deathProgress ? glm::mix(a.deathProgress, b.deathProgress, t)
+                                                         : b.deathProgress;
+    blendAll(a.body, b.body, t, body);
+
+    food = b.food;
+
+    bossActive    = b.bossActive;
+    bossPos       = a.bossActive ? blend(a.bossPos, b.bossPos, t) : b.bossPos;
+    bossPulseTime = glm::mix(a.bossPulseTime, b.bossPulseTime, t);
+    if (a.cloth.size() == b.cloth.size()) {
+        blendAll(a.cloth, b.cloth, t, cloth);
+        // unit normals: a plain lerp, the G-buffer pass renormalizes
+        clothNormals.resize(b.clothNormals.size());
+        for (size_t i = 0; i < clothNormals.size(); ++i) {
+            clothNormals[i] = glm::mix(a.clothNormals[i], b.clothNormals[i], t);
+        }
+    } else {
+        cloth = b.cloth;
+        clothNormals = b.clothNormals;
+    }
+
+    blendAll(a.lightPos, b.lightPos, t, lightPos);
+    lightColor = b.lightColor;
+}
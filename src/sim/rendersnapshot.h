@@ -0,0 +1,47 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "sim/arenasim.h"
+
+/**
+ * RenderSnapshot - a copy of everything the renderer draws from an ArenaSim
+ *
+ * The sim runs on fixed ticks and the renderer at display rate. After each
+ * tick a snapshot is captured; frames are drawn from interpolate() between
+ * the last two, so motion stays smooth however the two rates line up.
+ *
+ * Snapshots are taken whole and never edited afterwards, so the renderer
+ * can't see a half-stepped sim. Vectors keep their capacity across
+ * captures, so steady-state capture doesn't allocate.
+ */
+struct RenderSnapshot {
+    // moves longer than this in one tick are teleports / respawns: no blending
+    static constexpr float SNAP_DISTANCE = 2.0f;
+
+    uint64_t tick = 0;
+
+    glm::vec3 snakePos = glm::vec3(0.f);
+    float snakeJumpOffset = 0.f;
+    float deathProgress   = 0.f;
+    std::vector<glm::vec3> body;
+
+    std::vector<ArenaSim::FoodItem> food;
+
+    bool bossActive = false;
+    glm::vec3 bossPos = glm::vec3(0.f);
+    float bossPulseTime = 0.f;
+    std::vector<glm::vec3> cloth;          // GhostCloth::W * H positions, empty if no boss
+    std::vector<glm::vec3> clothNormals;   // and their vertex normals, from the solver
+
+    std::vector<glm::vec3> lightPos;
+    std::vector<glm::vec3> lightColor;
+
+    void capture(const ArenaSim &sim);
+
+    // this = a..b at alpha (0 = a, 1 = b). a is the older snapshot; discrete
+    // state (food, boss wake-up, body length) comes from b
+    void interpolate(const RenderSnapshot &a, const RenderSnapshot &b, float alpha);
+};
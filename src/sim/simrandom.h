@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+
+// Small PCG32 generator owned by each ArenaSim.
+// Replaces the global rand()/srand() state so independent arenas can run
+// side by side (and on different threads) and still replay the same way.
+// All the mapping to ints/floats is done here, not through <random>
+// distributions, so the sequence is identical on every platform.
+class SimRandom {
+public:
+    explicit SimRandom(uint64_t seed = 1234) { reseed(seed); }
+
+    void reseed(uint64_t seed) {
+        m_state = 0u;
+        m_inc   = (seed << 1u) | 1u;
+        nextU32();
+        m_state += seed;
+        nextU32();
+    }
+
+    uint32_t nextU32() {
+        uint64_t old = m_state;
+        m_state = old * 6364136223846793005ULL + m_inc;
+        uint32_t xorshifted = uint32_t(((old >> 18u) ^ old) >> 27u);
+        uint32_t rot = uint32_t(old >> 59u);
+        return (xorshifted >> rot) | (xorshifted << ((-rot) & 31u));
+    }
+
+    // uniform in [0, n), n > 0
+    int nextInt(int n) {
+        // Lemire's multiply-shift; bias is far below anything gameplay can notice
+        return int((uint64_t(nextU32()) * uint64_t(n)) >> 32);
+    }
+
+    // uniform in [0, 1)
+    float nextFloat() {
+        return float(nextU32() >> 8) * (1.0f / 16777216.0f);
+    }
+
+    // raw generator state, for hashing / comparing sims
+    uint64_t getState() const { return m_state; }
+
+private:
+    uint64_t m_state = 0;
+    uint64_t m_inc   = 1;
+};
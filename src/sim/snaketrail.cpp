@@ -0,0 +1,117 @@
+#include "sim/snaketrail.h"
+#include <algorithm>
+
+static size_t nextPow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+SnakeTrail::SnakeTrail(size_t capacity)
+    : m_maxSamples(capacity)
+{
+    capacity = nextPow2(std::max<size_t>(capacity, 2));
+    m_pos.resize(capacity);
+    m_dist.resize(capacity);
+    m_mask = capacity - 1;
+}
+
+void SnakeTrail::clear() {
+    m_head  = 0;
+    m_count = 0;
+}
+
+void SnakeTrail::push(const glm::vec3 &pos, bool jumped) {
+    double dist = 0.0;
+    if (m_count > 0) {
+        dist = m_dist[m_head];
+        if (!jumped) dist += double(glm::length(pos - m_pos[m_head]));
+    }
+
+    m_head = (m_head + 1) & m_mask;
+    m_pos[m_head]  = pos;
+    m_dist[m_head] = dist;
+
+    m_count = std::min(m_count + 1, std::min(m_maxSamples, capacity()));
+}
+
+void SnakeTrail::setMaxSamples(size_t maxSamples) {
+    m_maxSamples = std::max<size_t>(maxSamples, 1);
+    if (m_maxSamples <= capacity()) {
+        m_count = std::min(m_count, m_maxSamples);
+        return;
+    }
+
+    // grow: unroll oldest..newest into the front of the new ring
+    size_t newCap = nextPow2(m_maxSamples);
+    std::vector<glm::vec3> pos(newCap);
+    std::vector<double>    dist(newCap);
+    for (size_t i = 0; i < m_count; ++i) {
+        size_t k = m_count - 1 - i;
+        pos[i]  = m_pos[slot(k)];
+        dist[i] = m_dist[slot(k)];
+    }
+
+    m_pos.swap(pos);
+    m_dist.swap(dist);
+    m_mask = newCap - 1;
+    m_head = (m_count == 0) ? 0 : m_count - 1;
+}
+
+float SnakeTrail::length() const {
+    if (m_count < 2) return 0.f;
+    return float(distBack(m_count - 1));
+}
+
+glm::vec3 SnakeTrail::lerpSamples(size_t k, double d) const {
+    // sample k-1 is at or before d, sample k at or past it
+    const glm::vec3 &a = at(k - 1);
+    const glm::vec3 &b = at(k);
+    double da = distBack(k - 1);
+    double db = distBack(k);
+    double span = db - da;
+    if (span <= 0.0) return a;
+
+    float t = float((d - da) / span);
+
+    // a teleported stretch leaves a gap much longer than its arc length;
+    // snap to whichever side is closer rather than drawing through the gap
+    if (glm::length(b - a) > 2.0 * span + 1e-3) {
+        return (t < 0.5f) ? a : b;
+    }
+    return glm::mix(a, b, t);
+}
+
+bool SnakeTrail::sampleAtDistance(float d, glm::vec3 &out) const {
+    if (m_count == 0) return false;
+    if (d <= 0.f) { out = at(0); return true; }
+    if (m_count < 2 || d > length()) return false;
+
+    // first sample whose distance back is >= d
+    size_t lo = 1, hi = m_count - 1;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (distBack(mid) < d) lo = mid + 1;
+        else                   hi = mid;
+    }
+
+    out = lerpSamples(lo, d);
+    return true;
+}
+
+void SnakeTrail::sampleSpaced(float spacing, std::vector<glm::vec3> &out,
+                              const glm::vec3 &fallback) const {
+    const float total = length();
+
+    // targets increase monotonically, so one cursor walks the whole trail
+    size_t k = 1;
+    for (size_t i = 0; i < out.size(); ++i) {
+        double d = double(i + 1) * spacing;
+        if (m_count < 2 || d > total) {
+            std::fill(out.begin() + i, out.end(), fallback);
+            return;
+        }
+        while (k < m_count - 1 && distBack(k) < d) ++k;
+        out[i] = lerpSamples(k, d);
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+
+/**
+ * SnakeTrail - recent head positions in a power-of-two ring buffer
+ *
+ * Every sample also stores the cumulative arc length at the moment it was
+ * pushed, so "where was the head d units ago" is a binary search (or, for
+ * evenly spaced body segments, one forward walk) instead of an index guess.
+ *
+ * Sample 0 is the newest. Storage only grows when setMaxSamples() asks for
+ * more than the current capacity; push() never allocates.
+ */
+class SnakeTrail {
+public:
+    explicit SnakeTrail(size_t capacity = 64);
+
+    void clear();
+
+    // newest sample; the oldest is dropped once maxSamples are stored.
+    // jumped = true (portal teleport) adds no arc length for the gap, so the
+    // body keeps its spacing instead of stretching across the arena
+    void push(const glm::vec3 &pos, bool jumped = false);
+
+    // history limit, grows the ring (keeping its contents) if needed
+    void setMaxSamples(size_t maxSamples);
+
+    size_t size() const { return m_count; }
+    bool empty() const { return m_count == 0; }
+    size_t capacity() const { return m_pos.size(); }
+
+    // k = 0 is the newest sample. positions may be edited in place
+    // (portal teleports); arc lengths keep the values from push time
+    const glm::vec3 &at(size_t k) const { return m_pos[slot(k)]; }
+    glm::vec3 &at(size_t k) { return m_pos[slot(k)]; }
+
+    // cumulative arc length when sample k was pushed (what the spacing
+    // queries measure from)
+    double arcLengthAt(size_t k) const { return m_dist[slot(k)]; }
+
+    // arc length from the newest to the oldest sample
+    float length() const;
+
+    // position d units back along the trail from the newest sample.
+    // returns false if the trail is shorter than d
+    bool sampleAtDistance(float d, glm::vec3 &out) const;
+
+    // out[i] = sample at (i + 1) * spacing, or fallback past the end.
+    // one pass over the trail for all segments
+    void sampleSpaced(float spacing, std::vector<glm::vec3> &out,
+                      const glm::vec3 &fallback) const;
+
+private:
+    size_t slot(size_t k) const { return (m_head - k) & m_mask; }
+
+    // distance back from the newest sample to sample k
+    double distBack(size_t k) const { return m_dist[m_head] - m_dist[slot(k)]; }
+
+    glm::vec3 lerpSamples(size_t k, double d) const;
+
+    std::vector<glm::vec3> m_pos;
+    std::vector<double>    m_dist;   // cumulative arc length at push time
+
+    size_t m_mask  = 0;
+    size_t m_head  = 0;  // slot of the newest sample
+    size_t m_count = 0;
+    size_t m_maxSamples;
+};
@@ -0,0 +1,77 @@
+#include "sim/spatialhash.h"
+#include "sim/gridcoords.h"
+
+using namespace GridCoords;
+
+SpatialHash::SpatialHash()
+    : m_cellHead(GRID_SIZE * GRID_SIZE, -1)
+{
+}
+
+void SpatialHash::clear() {
+    std::fill(m_cellHead.begin(), m_cellHead.end(), -1);
+    m_next.clear();
+    m_prev.clear();
+    m_cellOf.clear();
+}
+
+void SpatialHash::resize(size_t count) {
+    for (size_t i = count; i < m_cellOf.size(); ++i) {
+        unlink(int(i));
+    }
+    m_next.resize(count, -1);
+    m_prev.resize(count, -1);
+    m_cellOf.resize(count, -1);
+}
+
+void SpatialHash::link(int id, int cell) {
+    int head = m_cellHead[cell];
+    m_prev[id] = -1;
+    m_next[id] = head;
+    if (head >= 0) m_prev[head] = id;
+    m_cellHead[cell] = id;
+    m_cellOf[id] = cell;
+}
+
+void SpatialHash::unlink(int id) {
+    int cell = m_cellOf[id];
+    if (cell < 0) return;
+
+    if (m_prev[id] >= 0) m_next[m_prev[id]] = m_next[id];
+    else                 m_cellHead[cell]   = m_next[id];
+    if (m_next[id] >= 0) m_prev[m_next[id]] = m_prev[id];
+
+    m_prev[id] = m_next[id] = -1;
+    m_cellOf[id] = -1;
+}
+
+void SpatialHash::update(int id, const glm::vec3 &pos) {
+    int cell = toCellClamped(pos.z) * GRID_SIZE + toCellClamped(pos.x);
+    if (m_cellOf[id] == cell) return;
+
+    unlink(id);
+    link(id, cell);
+}
+
+void SpatialHash::remove(int id) {
+    unlink(id);
+}
+
+int SpatialHash::findWithin(const glm::vec3 &center, float radius,
+                            const std::vector<glm::vec3> &positions, int minId) const {
+    // the mapping is monotonic, so the cells under [c - r, c + r] cover the disc
+    const int x0 = toCellClamped(center.x - radius), x1 = toCellClamped(center.x + radius);
+    const int z0 = toCellClamped(center.z - radius), z1 = toCellClamped(center.z + radius);
+    const float r2 = radius * radius;
+
+    for (int gz = z0; gz <= z1; ++gz) {
+        for (int gx = x0; gx <= x1; ++gx) {
+            for (int id = m_cellHead[gz * GRID_SIZE + gx]; id >= 0; id = m_next[id]) {
+                if (id < minId) continue;
+                glm::vec3 d = positions[id] - center;
+                if (glm::dot(d, d) < r2) return id;
+            }
+        }
+    }
+    return -1;
+}
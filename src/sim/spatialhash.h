@@ -0,0 +1,46 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+/**
+ * SpatialHash - uniform grid over the arena floor for point items
+ *
+ * Uses the GridCoords cell mapping. Each cell is an intrusive doubly linked
+ * list threaded through per-item arrays, so moving an item between cells is
+ * O(1) with no allocation, and an item that stays in its cell costs nothing.
+ *
+ * Items are identified by index (e.g. snake body segment i); the caller owns
+ * the positions and passes them to queries.
+ */
+class SpatialHash {
+public:
+    SpatialHash();
+
+    void clear();
+
+    // grow / shrink the item range, new items start unlinked
+    void resize(size_t count);
+    size_t size() const { return m_cellOf.size(); }
+
+    // (re)bucket item id at pos; a no-op if it stays in the same cell
+    void update(int id, const glm::vec3 &pos);
+    void remove(int id);
+
+    // grid cell (z * GRID_SIZE + x) item id is bucketed in, -1 if none
+    int getCell(int id) const { return m_cellOf[id]; }
+
+    // first item with id >= minId closer than radius to center (squared
+    // distance test), or -1. only visits the cells the radius overlaps in XZ
+    int findWithin(const glm::vec3 &center, float radius,
+                   const std::vector<glm::vec3> &positions, int minId = 0) const;
+
+private:
+    void link(int id, int cell);
+    void unlink(int id);
+
+    std::vector<int> m_cellHead; // first item per cell, -1 if empty
+    std::vector<int> m_next;
+    std::vector<int> m_prev;
+    std::vector<int> m_cellOf;   // -1 if not in the hash
+};
@@ -0,0 +1,151 @@
+#include "sim/threadpool.h"
+#include <algorithm>
+
+namespace {
+// which pool / worker the current thread belongs to (external threads: none)
+thread_local const ThreadPool *t_pool = nullptr;
+thread_local unsigned t_index = 0;
+}
+
+ThreadPool::ThreadPool(unsigned numThreads) {
+    if (numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (unsigned i = 0; i < numThreads; ++i) {
+        m_queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    m_workers.reserve(numThreads);
+    for (unsigned i = 0; i < numThreads; ++i) {
+        m_workers.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_workCv.notify_all();
+    for (auto &t : m_workers) t.join();
+}
+
+void ThreadPool::submit(Task task) {
+    // keep continuations on the submitting worker, spread external work round robin
+    unsigned q = (t_pool == this)
+                     ? t_index
+                     : m_nextQueue.fetch_add(1, std::memory_order_relaxed) % size();
+
+    m_pending.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(m_queues[q]->mutex);
+        m_queues[q]->tasks.push_back(std::move(task));
+    }
+    {
+        // bump under m_mutex so a worker about to sleep can't miss it
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queued.fetch_add(1);
+    }
+    m_workCv.notify_one();
+}
+
+bool ThreadPool::popLocal(unsigned index, Task &out) {
+    WorkerQueue &q = *m_queues[index];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.tasks.empty()) return false;
+    out = std::move(q.tasks.back());
+    q.tasks.pop_back();
+    m_queued.fetch_sub(1);
+    return true;
+}
+
+bool ThreadPool::steal(unsigned thief, Task &out) {
+    const unsigned n = size();
+    for (unsigned k = 1; k <= n; ++k) {
+        unsigned victim = (thief + k) % n;
+        if (victim == thief) continue;
+
+        WorkerQueue &q = *m_queues[victim];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.tasks.empty()) continue;
+        out = std::move(q.tasks.front());
+        q.tasks.pop_front();
+        m_queued.fetch_sub(1);
+        return true;
+    }
+    return false;
+}
+
+bool ThreadPool::runOne(unsigned index) {
+    Task task;
+    bool own = index < size() && popLocal(index, task);
+    if (!own && !steal(index, task)) return false;
+
+    task();
+    finishTask();
+    return true;
+}
+
+void ThreadPool::finishTask() {
+    if (m_pending.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_doneCv.notify_all();
+    }
+}
+
+void ThreadPool::workerLoop(unsigned index) {
+    t_pool  = this;
+    t_index = index;
+
+    while (true) {
+        if (runOne(index)) continue;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_workCv.wait(lock, [this] { return m_stop || m_queued.load() > 0; });
+        if (m_stop && m_queued.load() == 0) return;
+    }
+}
+
+void ThreadPool::wait() {
+    // external callers steal starting after the last worker
+    unsigned self = (t_pool == this) ? t_index : size();
+
+    while (m_pending.load() > 0) {
+        if (runOne(self)) continue;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_doneCv.wait(lock, [this] { return m_pending.load() == 0 || m_queued.load() > 0; });
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, size_t grain,
+                             const std::function<void(size_t, size_t)> &fn) {
+    if (count == 0) return;
+    grain = std::max<size_t>(1, grain);
+
+    const size_t chunks = (count + grain - 1) / grain;
+    if (chunks == 1 || size() == 1) {
+        fn(0, count);
+        return;
+    }
+
+    // the caller runs chunk 0 itself, the rest go to the pool
+    std::atomic<size_t> remaining(chunks - 1);
+    for (size_t c = 1; c < chunks; ++c) {
+        size_t begin = c * grain;
+        size_t end   = std::min(count, begin + grain);
+        submit([&fn, &remaining, begin, end] {
+            fn(begin, end);
+            remaining.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    fn(0, std::min(count, grain));
+
+    // help with whatever is queued until our chunks are all back
+    unsigned self = (t_pool == this) ? t_index : size();
+    while (remaining.load(std::memory_order_acquire) > 0) {
+        if (!runOne(self)) std::this_thread::yield();
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * ThreadPool - persistent workers with per-worker deques and work stealing
+ *
+ * - a worker pops its own newest task first (LIFO, cache friendly)
+ * - an idle worker steals the oldest task from another worker's deque
+ * - tasks submitted from inside a task go to the submitting worker's deque,
+ *   so continuations stay local unless someone else is idle
+ *
+ * wait() and parallelFor() make the calling thread help run tasks while it
+ * waits, so the pool is never idle while the caller blocks.
+ */
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    // numThreads == 0 picks std::thread::hardware_concurrency()
+    explicit ThreadPool(unsigned numThreads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // from m_queues, which is complete before any worker starts (m_workers
+    // is still growing while the first workers already run)
+    unsigned size() const { return (unsigned)m_queues.size(); }
+
+    void submit(Task task);
+
+    // blocks until every submitted task (including ones they submit) is done.
+    // must not be called from inside a task
+    void wait();
+
+    // runs fn(begin, end) over [0, count) in chunks of at most grain items
+    // and returns once all chunks are done. safe to call from inside a task
+    void parallelFor(size_t count, size_t grain,
+                     const std::function<void(size_t, size_t)> &fn);
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void workerLoop(unsigned index);
+    bool popLocal(unsigned index, Task &out);
+    bool steal(unsigned thief, Task &out);
+    bool runOne(unsigned index);
+    void finishTask();
+
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+    std::vector<std::thread> m_workers;
+
+    std::atomic<size_t>   m_queued{0};   // tasks sitting in some deque
+    std::atomic<size_t>   m_pending{0};  // submitted but not yet finished
+    std::atomic<unsigned> m_nextQueue{0};
+    bool m_stop = false;
+
+    std::mutex m_mutex;
+    std::condition_variable m_workCv;
+    std::condition_variable m_doneCv;
+};
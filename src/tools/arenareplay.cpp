@@ -0,0 +1,110 @@
+// arena_replay - replay a recorded session headlessly and check it
+//
+//   arena_replay <file> [--repeat N]
+//   arena_replay --record <file> [--ticks N] [--seed N] [--food N]
+//
+// Replays the recorded inputs through a fresh arena as fast as possible,
+// prints ticks/sec and compares the final state hash against the one stored
+// in the file. Exits 1 on a mismatch. --record writes a bot-driven session
+// instead, for a repeatable profiling workload without the GUI.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "sim/batchrunner.h"
+#include "sim/inputrecording.h"
+
+static void usage(const char *exe) {
+    std::fprintf(stderr,
+                 "usage: %s <file> [--repeat N]\n"
+                 "       %s --record <file> [--ticks N] [--seed N] [--food N]\n",
+                 exe, exe);
+}
+
+static int record(const std::string &path, uint64_t ticks, uint64_t seed, int food) {
+    ArenaSim sim;
+    sim.buildArena(seed);
+    sim.setFoodCount(food);
+    sim.setPlaying(true);
+
+    InputRecording rec;
+    rec.begin(seed, ArenaSim::FIXED_DT, food, sim.getBouncingLightCount());
+    sim.setRecorder(&rec);
+    for (uint64_t t = 0; t < ticks; ++t) {
+        sim.step(ArenaSim::FIXED_DT, BatchRunner::botInput(sim));
+    }
+    sim.setRecorder(nullptr);
+    rec.setFinalHash(sim.computeStateHash());
+
+    std::string error;
+    if (!rec.save(path, &error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    std::printf("recorded    %llu ticks (%zu runs) to %s\n",
+                (unsigned long long)rec.getNumTicks(), rec.getRuns().size(), path.c_str());
+    std::printf("final hash  %016llx\n", (unsigned long long)rec.getFinalHash());
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    std::string path;
+    bool recordMode = false;
+    int repeat = 1;
+    uint64_t ticks = 36000, seed = 1234;
+    int food = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        if (arg[0] != '-') {
+            if (!path.empty()) { usage(argv[0]); return 1; }
+            path = arg;
+            continue;
+        }
+        if (i + 1 >= argc) { usage(argv[0]); return 1; }
+        const char *val = argv[++i];
+
+        if      (!std::strcmp(arg, "--record")) { recordMode = true; path = val; }
+        else if (!std::strcmp(arg, "--repeat")) repeat = std::atoi(val);
+        else if (!std::strcmp(arg, "--ticks"))  ticks  = std::strtoull(val, nullptr, 10);
+        else if (!std::strcmp(arg, "--seed"))   seed   = std::strtoull(val, nullptr, 10);
+        else if (!std::strcmp(arg, "--food"))   food   = std::atoi(val);
+        else { usage(argv[0]); return 1; }
+    }
+    if (path.empty()) { usage(argv[0]); return 1; }
+
+    if (recordMode) return record(path, ticks, seed, food);
+
+    InputRecording rec;
+    std::string error;
+    if (!rec.load(path, &error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    uint64_t hash = 0;
+    double best = 0.0;
+    for (int r = 0; r < std::max(1, repeat); ++r) {
+        ArenaSim sim;
+        auto start = std::chrono::steady_clock::now();
+        rec.replay(sim);
+        auto stop = std::chrono::steady_clock::now();
+
+        double seconds = std::chrono::duration<double>(stop - start).count();
+        if (r == 0 || seconds < best) best = seconds;
+        hash = sim.computeStateHash();
+    }
+
+    bool match = (hash == rec.getFinalHash());
+    std::printf("ticks       %llu\n", (unsigned long long)rec.getNumTicks());
+    std::printf("seconds     %.3f (best of %d)\n", best, std::max(1, repeat));
+    if (best > 0.0) std::printf("ticks/sec   %.0f\n", double(rec.getNumTicks()) / best);
+    std::printf("hash        %016llx (recorded %016llx) %s\n",
+                (unsigned long long)hash, (unsigned long long)rec.getFinalHash(),
+                match ? "OK" : "MISMATCH");
+    return match ? 0 : 1;
+}
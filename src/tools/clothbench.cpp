@@ -0,0 +1,281 @@
+// cloth_bench - cloth solver throughput
+//
+//   cloth_bench [--steps N] [--size N] [--threads N]
+//
+// Times the previous 18x6 boss cloth (array of particle structs, a
+// constraint list walked one at a time) against ClothGrid<18, 6> and a
+// runtime-sized ClothGrid<> of size x size (default 256), scalar and SSE2,
+// then the SIMD size x size grid on a thread pool of 1, 2, 4 .. N threads
+// (default hardware_concurrency). Every solver gets the same settings, pins
+// and 60 Hz steps; scalar, SIMD and every thread count must end in the same
+// state. Prints ns per particle-substep.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "sim/arenasim.h"
+#include "sim/clothgrid.h"
+#include "sim/threadpool.h"
+
+namespace {
+
+// --- previous implementation, kept here as the baseline ---
+// AoS particles with a pinned flag and one constraint struct per pair
+class AosCloth {
+public:
+    struct Particle {
+        glm::vec3 pos, vel, prev;
+        float invMass;
+        bool pinned;
+    };
+
+    AosCloth(int w, int h, const ClothSettings &s) : m_w(w), m_h(h), m_s(s), m_particles(w * h) {
+        auto addRows = [&](int step, float rest, float compliance) {
+            for (int colour = 0; colour < 2; ++colour)
+                for (int y = 0; y < h; ++y)
+                    for (int x = 0; x + step < w; ++x)
+                        if ((x / step) % 2 == colour) m_constraints.push_back({ y * w + x, y * w + x + step, rest, compliance });
+        };
+        auto addColumns = [&](int step, float rest, float compliance) {
+            for (int colour = 0; colour < 2; ++colour)
+                for (int y = 0; y + step < h; ++y)
+                    if ((y / step) % 2 == colour)
+                        for (int x = 0; x < w; ++x) m_constraints.push_back({ y * w + x, (y + step) * w + x, rest, compliance });
+        };
+        addRows(1, s.restX, s.stretchCompliance);
+        addColumns(1, s.restY, s.stretchCompliance);
+        addRows(2, 2.f * s.restX, s.bendCompliance);
+        addColumns(2, 2.f * s.restY, s.bendCompliance);
+    }
+
+    void set(int x, int y, const glm::vec3 &pos, bool pinned) {
+        m_particles[y * m_w + x] = { pos, glm::vec3(0.f), pos, pinned ? 0.f : 1.f, pinned };
+    }
+
+    void step(float dt) {
+        const float h = dt / float(m_s.substeps);
+        const float invH2 = 1.f / (h * h);
+        for (int s = 0; s < m_s.substeps; ++s) {
+            m_time += h;
+            for (int y = 0; y < m_h; ++y) {
+                for (int x = 0; x < m_w; ++x) {
+                    Particle &p = m_particles[y * m_w + x];
+                    p.prev = p.pos;
+                    if (p.pinned) continue;
+                    float gust = std::sin(m_s.windFreq * m_time + m_s.windPhaseX * x + m_s.windPhaseY * y);
+                    p.vel += (m_s.gravity + m_s.windDir * (m_s.windStrength * gust)) * h;
+                    p.pos += p.vel * h;
+                }
+            }
+            for (const Constraint &c : m_constraints) {
+                Particle &a = m_particles[c.a], &b = m_particles[c.b];
+                float denom = a.invMass + b.invMass + c.compliance * invH2;
+                glm::vec3 d = b.pos - a.pos;
+                float dist = glm::length(d);
+                if (denom <= 0.f || dist < 1e-6f) continue;
+                glm::vec3 n = d / dist;
+                float dLambda = -(dist - c.rest) / denom;
+                a.pos -= a.invMass * dLambda * n;
+                b.pos += b.invMass * dLambda * n;
+            }
+            float damp = 1.f / (1.f + m_s.damping * h);
+            for (Particle &p : m_particles) {
+                if (p.pinned) continue;
+                glm::vec3 toCenter = p.pos - m_s.sphereCenter;
+                float d2 = glm::dot(toCenter, toCenter);
+                if (d2 < m_s.sphereRadius * m_s.sphereRadius) {
+                    p.pos = m_s.sphereCenter + toCenter * (m_s.sphereRadius / std::sqrt(d2 + 1e-8f));
+                }
+                if (p.pos.y < m_s.floorY) p.pos.y = m_s.floorY;
+                p.vel = (p.pos - p.prev) / h * damp;
+            }
+        }
+    }
+
+private:
+    struct Constraint { int a, b; float rest, compliance; };
+
+    int m_w, m_h;
+    ClothSettings m_s;
+    std::vector<Particle> m_particles;
+    std::vector<Constraint> m_constraints;
+    float m_time = 0.f;
+};
+
+ClothSettings benchSettings() {
+    ClothSettings s;
+    s.restX = 0.45f;
+    s.restY = 0.28f;
+    s.stretchCompliance = 1.f / 25.f;
+    s.bendCompliance = 0.5f;
+    s.damping = 1.1f;
+    s.substeps = 4;
+    s.windDir = glm::normalize(glm::vec3(1.f, 0.1f, 0.7f));
+    s.windStrength = 0.6f;
+    s.windPhaseX = 0.8f;
+    s.windPhaseY = 1.3f;
+    s.sphereCenter = glm::vec3(0.f, 2.2f, 0.f);
+    s.sphereRadius = 1.6f;
+    s.floorY = 0.f;
+    return s;
+}
+
+// sheet hanging from the middle fifth of its top row, starting above the sphere
+template <typename SetFn>
+void layOut(int w, int h, const ClothSettings &s, SetFn &&set) {
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            glm::vec3 pos((x - 0.5f * (w - 1)) * s.restX, 4.3f, (y - 0.5f * (h - 1)) * s.restY);
+            set(x, y, pos, y == 0 && std::abs(x - w / 2) <= std::max(w / 10, 2));
+        }
+    }
+}
+
+template <typename Grid>
+void setupGrid(Grid &g, const ClothSettings &s) {
+    g.settings() = s;
+    g.reset();
+    layOut(g.getWidth(), g.getHeight(), s, [&](int x, int y, const glm::vec3 &pos, bool pinned) {
+        if (pinned) g.pin(x, y, pos);
+        else        g.setParticle(x, y, pos);
+    });
+}
+
+// best of a few runs, so one noisy run doesn't decide it
+template <typename Make, typename Fn>
+double timeSteps(int steps, Make &&make, Fn &&fn) {
+    double best = 1e30;
+    for (int rep = 0; rep < 3; ++rep) {
+        auto cloth = make();
+        auto start = std::chrono::steady_clock::now();
+        for (int s = 0; s < steps; ++s) fn(*cloth);
+        double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, t);
+    }
+    return best;
+}
+
+void report(const char *name, double seconds, double particleSubsteps, double baseline) {
+    std::printf("%-22s %9.3f ms  %6.2f ns/particle-substep", name, seconds * 1e3,
+                seconds * 1e9 / particleSubsteps);
+    if (baseline > 0.0) std::printf("  (%.2fx)", baseline / seconds);
+    std::printf("\n");
+}
+
+template <typename Grid>
+int mismatches(const Grid &a, const Grid &b) {
+    int bad = 0;
+    for (int y = 0; y < a.getHeight(); ++y) {
+        for (int x = 0; x < a.getWidth(); ++x) {
+            if (a.getPos(x, y) != b.getPos(x, y) || a.getVel(x, y) != b.getVel(x, y) ||
+                a.getNormal(x, y) != b.getNormal(x, y)) {
+                bad++;
+            }
+        }
+    }
+    return bad;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    int steps = 2000;
+    int size  = 256;
+    int maxThreads = (int)std::max(1u, std::thread::hardware_concurrency());
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if      (!std::strcmp(argv[i], "--steps")) steps = std::atoi(argv[i + 1]);
+        else if (!std::strcmp(argv[i], "--size"))  size  = std::max(std::atoi(argv[i + 1]), 2);
+        else if (!std::strcmp(argv[i], "--threads")) maxThreads = std::max(std::atoi(argv[i + 1]), 1);
+    }
+
+    const ClothSettings s = benchSettings();
+    const float dt = ArenaSim::FIXED_DT;
+    using Small = ClothGrid<18, 6>;
+    using Large = ClothGrid<>;
+
+    std::printf("simd kernel %s\n", ClothSolver::hasSimd() ? "SSE2" : "unavailable (scalar fallback)");
+
+    // --- 18 x 6, the boss cloth ---
+    auto makeAos = [&] {
+        auto c = std::make_unique<AosCloth>(18, 6, s);
+        layOut(18, 6, s, [&](int x, int y, const glm::vec3 &pos, bool pinned) { c->set(x, y, pos, pinned); });
+        return c;
+    };
+    auto makeSmall = [&] {
+        auto g = std::make_unique<Small>();
+        setupGrid(*g, s);
+        return g;
+    };
+
+    double smallWork = 18.0 * 6 * s.substeps * steps;
+    double tAos    = timeSteps(steps, makeAos,   [&](AosCloth &c) { c.step(dt); });
+    double tScalar = timeSteps(steps, makeSmall, [&](Small &g) { g.stepScalar(dt); });
+    double tSimd   = timeSteps(steps, makeSmall, [&](Small &g) { g.stepSimd(dt); });
+
+    std::printf("\n18 x 6, %d steps\n", steps);
+    report("aos (previous)", tAos, smallWork, 0.0);
+    report("ClothGrid<18,6> scalar", tScalar, smallWork, tAos);
+    report("ClothGrid<18,6> simd", tSimd, smallWork, tAos);
+
+    auto a = makeSmall(), b = makeSmall();
+    for (int i = 0; i < steps; ++i) { a->stepScalar(dt); b->stepSimd(dt); }
+    int badSmall = mismatches(*a, *b);
+
+    // --- size x size, runtime-sized ---
+    int largeSteps = std::max(5, int(steps * 108.0 / (double(size) * size)));
+    auto makeLarge = [&] {
+        auto g = std::make_unique<Large>(size, size);
+        setupGrid(*g, s);
+        return g;
+    };
+    auto makeAosLarge = [&] {
+        auto c = std::make_unique<AosCloth>(size, size, s);
+        layOut(size, size, s, [&](int x, int y, const glm::vec3 &pos, bool pinned) { c->set(x, y, pos, pinned); });
+        return c;
+    };
+
+    double largeWork = double(size) * size * s.substeps * largeSteps;
+    double tAosL    = timeSteps(largeSteps, makeAosLarge, [&](AosCloth &c) { c.step(dt); });
+    double tScalarL = timeSteps(largeSteps, makeLarge, [&](Large &g) { g.stepScalar(dt); });
+    double tSimdL   = timeSteps(largeSteps, makeLarge, [&](Large &g) { g.stepSimd(dt); });
+
+    std::printf("\n%d x %d, %d steps\n", size, size, largeSteps);
+    report("aos (previous)", tAosL, largeWork, 0.0);
+    report("ClothGrid<> scalar", tScalarL, largeWork, tAosL);
+    report("ClothGrid<> simd", tSimdL, largeWork, tAosL);
+
+    auto c = makeLarge(), d = makeLarge();
+    for (int i = 0; i < largeSteps; ++i) { c->stepScalar(dt); d->stepSimd(dt); }
+    int badLarge = mismatches(*c, *d);
+
+    // --- size x size on the pool ---
+    std::printf("\n%d x %d simd, %d steps, thread pool\n", size, size, largeSteps);
+    int badThreads = 0;
+    for (int threads = 1; ; threads = std::min(threads * 2, maxThreads)) {
+        ThreadPool pool((unsigned)threads);
+        double t = timeSteps(largeSteps, makeLarge, [&](Large &g) { g.stepSimd(dt, &pool); });
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "%d thread%s", threads, threads == 1 ? "" : "s");
+        report(name, t, largeWork, tSimdL);
+
+        auto e = makeLarge();
+        for (int i = 0; i < largeSteps; ++i) e->stepSimd(dt, &pool);
+        badThreads += mismatches(*d, *e);
+
+        if (threads == maxThreads) break;
+    }
+
+    std::printf("\nscalar / simd mismatched particles: %d (18x6), %d (%dx%d)\n",
+                badSmall, badLarge, size, size);
+    std::printf("pool / single-thread mismatched particles: %d\n", badThreads);
+    return badSmall == 0 && badLarge == 0 && badThreads == 0 ? 0 : 1;
+}
@@ -0,0 +1,81 @@
+// light_bench - scalar vs SIMD bouncing-light kernel
+//
+//   light_bench [--lights N] [--steps N]
+//
+// Runs both kernels over the same arena maze and light set (best of 5),
+// checks they end in the same state, and prints ns per light-update.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "sim/arenasim.h"
+#include "sim/lightstore.h"
+#include "sim/simrandom.h"
+
+static LightStore makeLights(int count, const OccupancyGrid &maze) {
+    SimRandom rng(42);
+    LightStore lights;
+    while (lights.size() < count) {
+        float x = rng.nextFloat() * 56.f - 28.f;
+        float z = rng.nextFloat() * 56.f - 28.f;
+        if (maze.test(GridCoords::toCell(x), GridCoords::toCell(z))) continue;
+        glm::vec3 vel((rng.nextFloat() - 0.5f) * 18.f, 0.f, (rng.nextFloat() - 0.5f) * 18.f);
+        lights.addBouncing(glm::vec3(x, 1.5f, z), vel, glm::vec3(1.f));
+    }
+    return lights;
+}
+
+// best of a few runs over fresh copies, so one noisy run doesn't decide it
+template <typename Fn>
+static double timeSteps(const LightStore &initial, int steps, LightStore &out, Fn &&fn) {
+    double best = 1e30;
+    for (int rep = 0; rep < 5; ++rep) {
+        out = initial;
+        auto start = std::chrono::steady_clock::now();
+        for (int s = 0; s < steps; ++s) fn(out);
+        double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, t);
+    }
+    return best;
+}
+
+int main(int argc, char *argv[]) {
+    int numLights = 4096;
+    int steps     = 2000;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if      (!std::strcmp(argv[i], "--lights")) numLights = std::atoi(argv[i + 1]);
+        else if (!std::strcmp(argv[i], "--steps"))  steps     = std::atoi(argv[i + 1]);
+    }
+
+    ArenaSim sim;
+    sim.buildArena();
+    const OccupancyGrid &maze = sim.getMazeGrid();
+    const float dt = ArenaSim::FIXED_DT;
+    const float bounds = 28.0f;
+
+    const LightStore initial = makeLights(numLights, maze);
+    LightStore scalar, simd;
+
+    double tScalar = timeSteps(initial, steps, scalar,
+                               [&](LightStore &l) { l.updateScalar(dt, maze, bounds); });
+    double tSimd   = timeSteps(initial, steps, simd,
+                               [&](LightStore &l) { l.updateSimd(dt, maze, bounds); });
+
+    int mismatches = 0;
+    for (int i = 0; i < scalar.size(); ++i) {
+        if (scalar.getPos(i) != simd.getPos(i) || scalar.getVel(i) != simd.getVel(i)) mismatches++;
+    }
+
+    const double updates = double(numLights) * steps;
+    std::printf("lights %d, steps %d, simd kernel %s\n", numLights, steps,
+                LightStore::hasSimd() ? "SSE2" : "unavailable (scalar fallback)");
+    std::printf("scalar  %8.3f ms  %6.2f ns/light\n", tScalar * 1e3, tScalar * 1e9 / updates);
+    std::printf("simd    %8.3f ms  %6.2f ns/light  (%.2fx)\n", tSimd * 1e3, tSimd * 1e9 / updates,
+                tSimd > 0.0 ? tScalar / tSimd : 0.0);
+    std::printf("mismatched lights: %d\n", mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
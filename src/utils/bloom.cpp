@@ -0,0 +1,104 @@
+#include "bloom.h"
+
+#include <algorithm>
+
+Bloom::~Bloom() {
+    destroy();
+}
+
+void Bloom::init(int width, int height) {
+    destroy();
+
+    m_downShader.create("resources/shaders/fullscreen_quad.vert", "resources/shaders/bloom_downsample.frag");
+    m_upShader.create("resources/shaders/fullscreen_quad.vert", "resources/shaders/bloom_upsample.frag");
+
+    glGenFramebuffers(1, &m_fbo);
+
+    m_width = m_height = 0;
+    resize(width, height);
+}
+
+void Bloom::resize(int width, int height) {
+    if (width <= 0 || height <= 0) return;
+    if (width == m_width && height == m_height) return;
+
+    m_width  = width;
+    m_height = height;
+    createMips();
+}
+
+void Bloom::createMips() {
+    for (Mip &mip : m_mips) {
+        if (mip.tex) glDeleteTextures(1, &mip.tex);
+        mip = Mip();
+    }
+
+    int w = m_width, h = m_height;
+    for (Mip &mip : m_mips) {
+        w = std::max(1, w / 2);
+        h = std::max(1, h / 2);
+        mip.width  = w;
+        mip.height = h;
+
+        // glow is never negative and doesn't need alpha: half the bytes of RGBA16F
+        glGenTextures(1, &mip.tex);
+        glBindTexture(GL_TEXTURE_2D, mip.tex);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R11F_G11F_B10F, w, h, 0, GL_RGB, GL_FLOAT, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void Bloom::destroy() {
+    for (Mip &mip : m_mips) {
+        if (mip.tex) glDeleteTextures(1, &mip.tex);
+        mip = Mip();
+    }
+    if (m_fbo) glDeleteFramebuffers(1, &m_fbo);
+    m_fbo = 0;
+    m_downShader.destroy();
+    m_upShader.destroy();
+    m_width = m_height = 0;
+}
+
+GLuint Bloom::render(GLuint sourceTex, GLuint quadVAO) {
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    glBindVertexArray(quadVAO);
+    glDisable(GL_BLEND);
+    glActiveTexture(GL_TEXTURE0);
+
+    // --- down: source -> 1/2 -> ... -> 1/32 ---
+    m_downShader.use();
+    m_downShader.set("srcTexture", 0);
+    for (int i = 0; i < NUM_MIPS; ++i) {
+        const Mip &mip = m_mips[i];
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, mip.tex, 0);
+        glViewport(0, 0, mip.width, mip.height);
+
+        glBindTexture(GL_TEXTURE_2D, i == 0 ? sourceTex : m_mips[i - 1].tex);
+        m_downShader.set("karisAverage", i == 0 ? 1 : 0);
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+    }
+
+    // --- up: add each level onto the next larger one ---
+    m_upShader.use();
+    m_upShader.set("srcTexture", 0);
+    m_upShader.set("filterRadius", m_filterRadius);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+    glBlendEquation(GL_FUNC_ADD);
+    for (int i = NUM_MIPS - 1; i > 0; --i) {
+        const Mip &dst = m_mips[i - 1];
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, dst.tex, 0);
+        glViewport(0, 0, dst.width, dst.height);
+
+        glBindTexture(GL_TEXTURE_2D, m_mips[i].tex);
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+    }
+    glDisable(GL_BLEND);
+
+    return getTexture();
+}
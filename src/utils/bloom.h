@@ -0,0 +1,60 @@
+#pragma once
+
+#ifdef __APPLE__
+#define GL_SILENCE_DEPRECATION
+#endif
+#include <GL/glew.h>
+
+#include "shaderprogram.h"
+
+/**
+ * Bloom - progressive downsample / upsample glow chain
+ *
+ * The source is filtered down into NUM_MIPS targets at 1/2 .. 1/32 of the
+ * screen with a 13-tap box filter (the first level Karis-averaged so single
+ * bright pixels don't flicker), then walked back up with a 3x3 tent filter,
+ * each level added onto the next larger one. The 1/2 resolution level ends
+ * up holding the whole glow, which composite.frag adds onto the scene.
+ *
+ * Compared to the old 10 full-resolution Gaussian passes this touches about
+ * 2/3 of a screen's worth of pixels in total and spreads much wider.
+ */
+class Bloom {
+public:
+    static constexpr int NUM_MIPS = 5;   // 1/2, 1/4, 1/8, 1/16, 1/32
+
+    Bloom() = default;
+    ~Bloom();
+
+    void init(int width, int height);
+    void resize(int width, int height);
+    void destroy();
+
+    // runs the chain on an HDR texture; quadVAO is a fullscreen triangle pair.
+    // Leaves the chain's framebuffer bound. Returns getTexture()
+    GLuint render(GLuint sourceTex, GLuint quadVAO);
+
+    GLuint getTexture() const { return m_mips[0].tex; }
+
+    // upsample tent radius in uv units of the level being written
+    void setFilterRadius(float radius) { m_filterRadius = radius; }
+
+private:
+    struct Mip {
+        GLuint tex = 0;
+        int width  = 0;
+        int height = 0;
+    };
+
+    void createMips();
+
+    int m_width  = 0;
+    int m_height = 0;
+    float m_filterRadius = 0.005f;
+
+    Mip m_mips[NUM_MIPS];
+    GLuint m_fbo = 0;
+
+    ShaderProgram m_downShader;
+    ShaderProgram m_upShader;
+};
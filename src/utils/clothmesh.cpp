@@ -0,0 +1,122 @@
+#include "clothmesh.h"
+
+#include <cstddef>
+#include <vector>
+
+ClothMesh::~ClothMesh() {
+    destroy();
+}
+
+void ClothMesh::init(int width, int height) {
+    destroy();
+    if (width < 2 || height < 2) return;
+
+    m_width  = width;
+    m_height = height;
+
+    std::vector<GLuint> indices;
+    indices.reserve((width - 1) * (height - 1) * 6);
+    for (int y = 0; y + 1 < height; ++y) {
+        for (int x = 0; x + 1 < width; ++x) {
+            GLuint i = GLuint(y * width + x);
+            GLuint right = i + 1, below = i + GLuint(width);
+            indices.insert(indices.end(), { i, right, below });
+            indices.insert(indices.end(), { right, below + 1, below });
+        }
+    }
+    m_numIndices = (int)indices.size();
+
+    glGenVertexArrays(1, &m_vao);
+    glGenBuffers(1, &m_vbo);
+    glGenBuffers(1, &m_ibo);
+
+    glBindVertexArray(m_vao);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+
+    const GLsizeiptr bytes = GLsizeiptr(NUM_REGIONS) * getNumVertices() * sizeof(Vertex);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    if (GLEW_ARB_buffer_storage) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, bytes, nullptr, flags);
+        m_persistent = static_cast<Vertex *>(glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes, flags));
+    } else {
+        glBufferData(GL_ARRAY_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+    }
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, pos));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void ClothMesh::destroy() {
+    for (GLsync &fence : m_fences) {
+        if (fence) glDeleteSync(fence);
+        fence = nullptr;
+    }
+    if (m_persistent) {
+        glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        m_persistent = nullptr;
+    }
+    if (m_vao) glDeleteVertexArrays(1, &m_vao);
+    if (m_vbo) glDeleteBuffers(1, &m_vbo);
+    if (m_ibo) glDeleteBuffers(1, &m_ibo);
+    m_vao = m_vbo = m_ibo = 0;
+    m_width = m_height = m_numIndices = 0;
+    m_region = 0;
+    m_written = false;
+}
+
+ClothMesh::Vertex *ClothMesh::beginWrite() {
+    if (!m_vbo) return nullptr;
+
+    // the draw NUM_REGIONS - 1 frames back; normally long done
+    GLsync &fence = m_fences[m_region];
+    if (fence) {
+        if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+            m_stalls++;
+            while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED) {}
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    const int count = getNumVertices();
+    if (m_persistent) return m_persistent + m_region * count;
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    void *ptr = glMapBufferRange(GL_ARRAY_BUFFER, GLintptr(m_region) * count * sizeof(Vertex),
+                                 GLsizeiptr(count) * sizeof(Vertex),
+                                 GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (!ptr) glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return static_cast<Vertex *>(ptr);
+}
+
+void ClothMesh::endWrite() {
+    if (!m_vbo) return;
+    if (!m_persistent) {
+        glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    m_written = true;
+}
+
+void ClothMesh::draw() {
+    if (!m_vao || !m_written) return;
+
+    glBindVertexArray(m_vao);
+    glDrawElementsBaseVertex(GL_TRIANGLES, m_numIndices, GL_UNSIGNED_INT, nullptr,
+                             m_region * getNumVertices());
+    glBindVertexArray(0);
+
+    m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_region = (m_region + 1) % NUM_REGIONS;
+    m_written = false;
+}
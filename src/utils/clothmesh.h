@@ -0,0 +1,69 @@
+#pragma once
+
+#ifdef __APPLE__
+#define GL_SILENCE_DEPRECATION
+#endif
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+/**
+ * ClothMesh - a width x height particle grid streamed to the GPU every frame
+ *
+ * One vertex per particle (position + normal, attributes 0 and 1 as in
+ * gbuffer.vert), particle (x, y) at y * width + x. The two triangles per
+ * cell live in a static index buffer built once by init().
+ *
+ * The vertex buffer holds NUM_REGIONS copies of the grid. Each frame
+ * beginWrite() hands out the next region to fill, draw() draws it and
+ * fences it; the region isn't written again until that fence has passed,
+ * NUM_REGIONS - 1 frames later, so the CPU never waits on a draw in flight.
+ *
+ * With ARB_buffer_storage (GL 4.4, not on the 4.1 core profile macOS gives
+ * us) the buffer is mapped once, persistent + coherent. Without it each
+ * region is mapped per frame, unsynchronized - the fence already says the
+ * GPU is done with it.
+ */
+class ClothMesh {
+public:
+    static constexpr int NUM_REGIONS = 3;
+
+    struct Vertex {
+        glm::vec3 pos;
+        glm::vec3 normal;
+    };
+    static_assert(sizeof(Vertex) == 6 * sizeof(float), "Vertex must be tightly packed");
+
+    ClothMesh() = default;
+    ~ClothMesh();
+
+    void init(int width, int height);
+    void destroy();
+
+    // width * height vertices to fill, nullptr if there's no buffer;
+    // every beginWrite() needs an endWrite() before the next draw()
+    Vertex *beginWrite();
+    void endWrite();
+
+    // draws the region last written, then fences it (caller binds the program)
+    void draw();
+
+    bool isPersistent() const { return m_persistent != nullptr; }
+    int getNumVertices() const { return m_width * m_height; }
+    // beginWrite() calls that found their region still in use by the GPU
+    int getNumStalls() const { return m_stalls; }
+
+private:
+    int m_width  = 0;
+    int m_height = 0;
+    int m_numIndices = 0;
+
+    GLuint m_vao = 0;
+    GLuint m_vbo = 0;
+    GLuint m_ibo = 0;
+
+    Vertex *m_persistent = nullptr;   // whole buffer, when mapped for good
+    GLsync m_fences[NUM_REGIONS] = {nullptr, nullptr, nullptr};
+    int m_region = 0;    // region being written / about to be drawn
+    bool m_written = false;
+    int m_stalls = 0;
+};
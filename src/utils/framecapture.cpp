@@ -0,0 +1,99 @@
+#include "framecapture.h"
+
+#include <QImage>
+#include <QString>
+#include <cstdio>
+#include <iostream>
+
+FrameCapture::~FrameCapture() {
+    destroy();
+}
+
+bool FrameCapture::init(int width, int height, const std::string &dir, Format format) {
+    destroy();
+
+    m_width  = width;
+    m_height = height;
+    m_dir    = dir;
+    m_format = format;
+
+    if (m_format == FORMAT_RAW) {
+        m_raw.open(m_dir + "/frames.rgba", std::ios::binary);
+        if (!m_raw) {
+            std::cerr << "FrameCapture: cannot open " << m_dir << "/frames.rgba" << std::endl;
+            return false;
+        }
+    }
+
+    const GLsizeiptr bytes = GLsizeiptr(width) * height * 4;
+    glGenBuffers(NUM_PBOS, m_pbos);
+    for (GLuint pbo : m_pbos) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return true;
+}
+
+void FrameCapture::destroy() {
+    if (m_pbos[0]) glDeleteBuffers(NUM_PBOS, m_pbos);
+    for (int i = 0; i < NUM_PBOS; ++i) {
+        m_pbos[i] = 0;
+        m_pendingFrame[i] = -1;
+    }
+    if (m_raw.is_open()) m_raw.close();
+    m_next = 0;
+}
+
+void FrameCapture::capture(GLuint fbo, int frame) {
+    // the slot's previous read was issued NUM_PBOS - 1 frames ago
+    if (m_pendingFrame[m_next] >= 0) write(m_next);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    if (fbo) glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbos[m_next]);
+    glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    m_pendingFrame[m_next] = frame;
+    m_next = (m_next + 1) % NUM_PBOS;
+}
+
+void FrameCapture::finish() {
+    // oldest first, so raw frames stay in order
+    for (int i = 0; i < NUM_PBOS; ++i) {
+        int slot = (m_next + i) % NUM_PBOS;
+        if (m_pendingFrame[slot] >= 0) write(slot);
+    }
+    if (m_raw.is_open()) m_raw.flush();
+}
+
+void FrameCapture::write(int slot) {
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbos[slot]);
+    const size_t bytes = size_t(m_width) * m_height * 4;
+    const uint8_t *pixels = (const uint8_t*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT);
+    if (pixels) {
+        if (m_format == FORMAT_RAW) {
+            m_raw.write((const char*)pixels, bytes);
+        } else {
+            char name[32];
+            std::snprintf(name, sizeof(name), "/frame_%05d.png", m_pendingFrame[slot]);
+            // GL rows are bottom-up
+            QImage image(pixels, m_width, m_height, m_width * 4, QImage::Format_RGBA8888);
+            image.mirrored().save(QString::fromStdString(m_dir + name));
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        ++m_written;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    m_pendingFrame[slot] = -1;
+}
+
+bool FrameCapture::saveFramebuffer(GLuint fbo, int width, int height, const std::string &path) {
+    QImage image(width, height, QImage::Format_RGBA8888);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, image.bits());
+    return image.mirrored().save(QString::fromStdString(path));
+}
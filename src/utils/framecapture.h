@@ -0,0 +1,58 @@
+#pragma once
+
+#ifdef __APPLE__
+#define GL_SILENCE_DEPRECATION
+#endif
+#include <GL/glew.h>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+/**
+ * FrameCapture - writes rendered frames to disk without stalling the GPU
+ *
+ * capture() only queues a glReadPixels into one of NUM_PBOS pixel buffers.
+ * The buffer is mapped and written out when the ring comes back round to
+ * it, by which time the copy has long finished. finish() drains the rest.
+ *
+ *   FORMAT_PNG  one <dir>/frame_00000.png per frame
+ *   FORMAT_RAW  everything appended to <dir>/frames.rgba: width * height * 4
+ *               bytes per frame, RGBA8, rows bottom-up as GL returns them
+ */
+class FrameCapture {
+public:
+    enum Format { FORMAT_PNG, FORMAT_RAW };
+
+    static constexpr int NUM_PBOS = 3;
+
+    FrameCapture() = default;
+    ~FrameCapture();
+
+    bool init(int width, int height, const std::string &dir, Format format);
+    void destroy();
+
+    // reads color attachment 0 of fbo; frame is the number used in the file name
+    void capture(GLuint fbo, int frame);
+
+    // writes out every queued frame
+    void finish();
+
+    int getNumWritten() const { return m_written; }
+
+    // blocking single-frame read, for one-off screenshots
+    static bool saveFramebuffer(GLuint fbo, int width, int height, const std::string &path);
+
+private:
+    void write(int slot);
+
+    int m_width  = 0;
+    int m_height = 0;
+    std::string m_dir;
+    Format m_format = FORMAT_PNG;
+    std::ofstream m_raw;
+
+    GLuint m_pbos[NUM_PBOS] = {0, 0, 0};
+    int m_pendingFrame[NUM_PBOS] = {-1, -1, -1};   // -1 = empty
+    int m_next = 0;
+    int m_written = 0;
+};
@@ -0,0 +1,168 @@
+#include "frameprofiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+// ---------- CpuScope ----------
+
+FrameProfiler::CpuScope::CpuScope(FrameProfiler &profiler, const char *name)
+    : m_profiler(profiler), m_name(name), m_start(std::chrono::steady_clock::now())
+{
+}
+
+FrameProfiler::CpuScope::~CpuScope() {
+    auto stop = std::chrono::steady_clock::now();
+    m_profiler.addCpuSample(m_name, std::chrono::duration<double, std::milli>(stop - m_start).count());
+}
+
+// ---------- FrameProfiler ----------
+
+FrameProfiler::~FrameProfiler() {
+    destroy();
+}
+
+void FrameProfiler::init() {
+    destroy();
+    m_gpuReady = true;
+}
+
+void FrameProfiler::destroy() {
+    if (!m_gpuReady) return;
+    if (m_openSection >= 0) glEndQuery(GL_TIME_ELAPSED);
+    m_openSection = -1;
+    for (auto &set : m_pending) {
+        for (const Pending &p : set) m_freeQueries.push_back(p.query);
+        set.clear();
+    }
+    if (!m_freeQueries.empty()) glDeleteQueries((GLsizei)m_freeQueries.size(), m_freeQueries.data());
+    m_freeQueries.clear();
+    m_gpuReady = false;
+}
+
+int FrameProfiler::section(const char *name, bool gpu) {
+    for (int i = 0; i < (int)m_sections.size(); ++i) {
+        if (m_sections[i].gpu == gpu && m_sections[i].name == name) return i;
+    }
+    Section s;
+    s.name = name;
+    s.gpu  = gpu;
+    s.history.reserve(HISTORY);
+    m_sections.push_back(std::move(s));
+    return (int)m_sections.size() - 1;
+}
+
+void FrameProfiler::addSample(int index, double ms) {
+    Section &s = m_sections[index];
+    if ((int)s.history.size() < HISTORY) {
+        s.history.push_back((float)ms);
+    } else {
+        s.history[s.head] = (float)ms;
+    }
+    s.head = (s.head + 1) % HISTORY;
+}
+
+void FrameProfiler::addCpuSample(const char *name, double ms) {
+    addSample(section(name, false), ms);
+}
+
+// reads back whatever of a set has finished; never waits
+void FrameProfiler::collect(int slot) {
+    for (const Pending &p : m_pending[slot]) {
+        GLint available = 0;
+        glGetQueryObjectiv(p.query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(p.query, GL_QUERY_RESULT, &ns);
+            addSample(p.section, double(ns) * 1e-6);
+        } else {
+            ++m_dropped;
+        }
+        m_freeQueries.push_back(p.query);
+    }
+    m_pending[slot].clear();
+}
+
+void FrameProfiler::beginFrame() {
+    if (!m_gpuReady) return;
+    if (m_openSection >= 0) endGpu();
+
+    // the set issued FRAMES_IN_FLIGHT - 1 frames ago becomes this frame's
+    m_slot = (m_slot + 1) % FRAMES_IN_FLIGHT;
+    collect(m_slot);
+}
+
+void FrameProfiler::beginGpu(const char *name) {
+    if (!m_gpuReady) return;
+    if (m_openSection >= 0) endGpu();
+
+    GLuint query;
+    if (m_freeQueries.empty()) {
+        glGenQueries(1, &query);
+    } else {
+        query = m_freeQueries.back();
+        m_freeQueries.pop_back();
+    }
+    m_openSection = section(name, true);
+    m_pending[m_slot].push_back({ query, m_openSection });
+    glBeginQuery(GL_TIME_ELAPSED, query);
+}
+
+void FrameProfiler::endGpu() {
+    if (!m_gpuReady || m_openSection < 0) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    m_openSection = -1;
+}
+
+FrameProfiler::Stats FrameProfiler::getStats(int index) const {
+    Stats st;
+    std::vector<float> v = m_sections[index].history;
+    st.samples = (int)v.size();
+    if (v.empty()) return st;
+
+    double sum = 0.0;
+    for (float x : v) sum += x;
+    st.avg = sum / v.size();
+
+    auto pct = [&v](double p) {
+        size_t k = std::min(v.size() - 1, size_t(p * (v.size() - 1) + 0.5));
+        std::nth_element(v.begin(), v.begin() + k, v.end());
+        return double(v[k]);
+    };
+    st.p50 = pct(0.50);
+    st.p95 = pct(0.95);
+    st.p99 = pct(0.99);
+    st.max = *std::max_element(v.begin(), v.end());
+    return st;
+}
+
+std::string FrameProfiler::report() const {
+    char line[128];
+    std::snprintf(line, sizeof(line), "%-14s %6s %6s %6s %6s  ms\n", "section", "avg", "p50", "p95", "p99");
+    std::string out = line;
+    for (int i = 0; i < getNumSections(); ++i) {
+        Stats st = getStats(i);
+        std::snprintf(line, sizeof(line), "%-4s %-9s %6.2f %6.2f %6.2f %6.2f\n",
+                      isGpu(i) ? "gpu" : "cpu", getName(i).c_str(), st.avg, st.p50, st.p95, st.p99);
+        out += line;
+    }
+    if (m_dropped) {
+        std::snprintf(line, sizeof(line), "(%llu gpu results not ready, dropped)\n", (unsigned long long)m_dropped);
+        out += line;
+    }
+    return out;
+}
+
+bool FrameProfiler::writeCsv(const std::string &path) const {
+    std::ofstream out(path);
+    if (!out) return false;
+
+    out << "section,kind,samples,avg_ms,p50_ms,p95_ms,p99_ms,max_ms\n";
+    for (int i = 0; i < getNumSections(); ++i) {
+        Stats st = getStats(i);
+        out << getName(i) << ',' << (isGpu(i) ? "gpu" : "cpu") << ',' << st.samples << ','
+            << st.avg << ',' << st.p50 << ',' << st.p95 << ',' << st.p99 << ',' << st.max << '\n';
+    }
+    return bool(out);
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#ifdef __APPLE__
+#define GL_SILENCE_DEPRECATION
+#endif
+#include <GL/glew.h>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * FrameProfiler - per-pass GPU times and scoped CPU times with rolling stats
+ *
+ * GPU sections are GL_TIME_ELAPSED queries. Each frame's queries go into
+ * one of FRAMES_IN_FLIGHT sets; a set is only read back when the ring
+ * comes round to it again, and only results the driver reports as
+ * available are taken. Anything still pending is dropped (and counted),
+ * so reading the profiler never waits on the GPU.
+ *
+ * CPU sections are timed with steady_clock, usually through CpuScope.
+ *
+ * Every section keeps its last HISTORY samples (ms) for the average and
+ * p50 / p95 / p99.
+ *
+ *   profiler.beginFrame();
+ *   profiler.beginGpu("geometry"); ... profiler.endGpu();
+ *   { FrameProfiler::CpuScope t(profiler, "sim"); ... }
+ */
+class FrameProfiler {
+public:
+    static constexpr int FRAMES_IN_FLIGHT = 3;
+    static constexpr int HISTORY          = 300;   // ~5 s at 60 fps
+
+    struct Stats {
+        int    samples = 0;
+        double avg = 0.0, p50 = 0.0, p95 = 0.0, p99 = 0.0, max = 0.0;
+    };
+
+    class CpuScope {
+    public:
+        CpuScope(FrameProfiler &profiler, const char *name);
+        ~CpuScope();
+    private:
+        FrameProfiler &m_profiler;
+        const char *m_name;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    FrameProfiler() = default;
+    ~FrameProfiler();
+
+    // GPU timing needs a current context; before init() only CPU sections record
+    void init();
+    void destroy();
+
+    void beginFrame();
+
+    // GL_TIME_ELAPSED can't nest: beginning a section ends the open one
+    void beginGpu(const char *name);
+    void endGpu();
+
+    void addCpuSample(const char *name, double ms);
+
+    Stats getStats(int section) const;
+    int getNumSections() const { return (int)m_sections.size(); }
+    const std::string &getName(int section) const { return m_sections[section].name; }
+    bool isGpu(int section) const { return m_sections[section].gpu; }
+
+    // GPU results that weren't ready when their set came round again
+    uint64_t getDroppedQueries() const { return m_dropped; }
+
+    // one line per section, for the overlay
+    std::string report() const;
+
+    // section,kind,samples,avg_ms,p50_ms,p95_ms,p99_ms,max_ms
+    bool writeCsv(const std::string &path) const;
+
+private:
+    struct Section {
+        std::string name;
+        bool gpu = false;
+        std::vector<float> history;   // ring of HISTORY
+        int head = 0;
+    };
+
+    struct Pending {
+        GLuint query;
+        int section;
+    };
+
+    int  section(const char *name, bool gpu);
+    void addSample(int section, double ms);
+    void collect(int slot);
+
+    std::vector<Section> m_sections;
+
+    bool m_gpuReady = false;
+    int  m_slot = 0;
+    int  m_openSection = -1;
+    std::vector<GLuint>  m_freeQueries;
+    std::vector<Pending> m_pending[FRAMES_IN_FLIGHT];
+    uint64_t m_dropped = 0;
+};
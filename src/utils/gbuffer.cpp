@@ -8,11 +8,12 @@ GBuffer::~GBuffer() {
     destroy();
 }
 
-void GBuffer::init(int width, int height) {
+void GBuffer::init(int width, int height, Layout layout) {
     if (width <= 0 || height <= 0) return;
 
     m_width = width;
     m_height = height;
+    m_layout = layout;
 
     destroy();
 
@@ -28,13 +29,14 @@ void GBuffer::init(int width, int height) {
         GL_COLOR_ATTACHMENT2,
         GL_COLOR_ATTACHMENT3
     };
-    glDrawBuffers(4, attachments);
+    glDrawBuffers(isCompact() ? 3 : 4, attachments);
 
     GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
     if (status != GL_FRAMEBUFFER_COMPLETE) {
         std::cerr << "❌ GBuffer Incomplete: 0x" << std::hex << status << std::dec << std::endl;
     } else {
-        std::cout << "✅ GBuffer Initialized (Safe Mode: GL_RGBA)" << std::endl;
+        std::cout << "✅ GBuffer Initialized (" << (isCompact() ? "compact" : "full") << ", "
+                  << getBytesPerPixel() << " bytes/pixel)" << std::endl;
     }
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -43,7 +45,7 @@ void GBuffer::init(int width, int height) {
 void GBuffer::resize(int width, int height) {
     if (width <= 0 || height <= 0) return;
     if (m_width == width && m_height == height) return;
-    init(width, height);
+    init(width, height, m_layout);
 }
 
 void GBuffer::bindForWriting() {
@@ -51,41 +53,49 @@ void GBuffer::bindForWriting() {
     glViewport(0, 0, m_width, m_height);
 }
 
+size_t GBuffer::getBytesPerPixel() const {
+    const size_t depth = 4;   // DEPTH_COMPONENT24, padded to 32 bits
+    if (isCompact()) return 4 /* RG16 */ + 4 /* RGBA8 */ + 4 /* R11G11B10F */ + depth;
+    return 16 /* RGBA32F */ + 8 /* RGBA16F */ + 4 /* RGBA8 */ + 8 /* RGBA16F */ + depth;
+}
+
+static GLuint makeTarget(int width, int height, GLenum internalFormat, GLenum format,
+                         GLenum type, GLenum attachment, GLenum filter = GL_NEAREST) {
+    GLuint tex;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, tex, 0);
+    return tex;
+}
+
 void GBuffer::createTextures(int width, int height) {
-    // SAFE MODE: Use GL_RGBA (Standard 8-bit) instead of GL_RGBA16F
-    // This fixes the "Unloadable Texture" error on some Macs
+    // sized formats throughout; the old unsized GL_RGBA ended up as 8-bit
+    // UNORM on most drivers, which clamped world positions to [0, 1]
+
+    if (isCompact()) {
+        // Normal: octahedral encoding, 2 x 16-bit
+        m_normalTex   = makeTarget(width, height, GL_RG16, GL_RG, GL_UNSIGNED_SHORT, GL_COLOR_ATTACHMENT0);
+        // Albedo
+        m_albedoTex   = makeTarget(width, height, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, GL_COLOR_ATTACHMENT1);
+        // Emissive: HDR but never negative. Linear so Bloom's first
+        // downsample gets 2x2 averages per tap
+        m_emissiveTex = makeTarget(width, height, GL_R11F_G11F_B10F, GL_RGB, GL_FLOAT, GL_COLOR_ATTACHMENT2, GL_LINEAR);
+        return;
+    }
 
     // Position
-    glGenTextures(1, &m_positionTex);
-    glBindTexture(GL_TEXTURE_2D, m_positionTex);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_positionTex, 0);
-
+    m_positionTex = makeTarget(width, height, GL_RGBA32F, GL_RGBA, GL_FLOAT, GL_COLOR_ATTACHMENT0);
     // Normal
-    glGenTextures(1, &m_normalTex);
-    glBindTexture(GL_TEXTURE_2D, m_normalTex);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_normalTex, 0);
-
+    m_normalTex   = makeTarget(width, height, GL_RGBA16F, GL_RGBA, GL_FLOAT, GL_COLOR_ATTACHMENT1);
     // Albedo
-    glGenTextures(1, &m_albedoTex);
-    glBindTexture(GL_TEXTURE_2D, m_albedoTex);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, m_albedoTex, 0);
-
-    // Emissive
-    glGenTextures(1, &m_emissiveTex);
-    glBindTexture(GL_TEXTURE_2D, m_emissiveTex);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT3, GL_TEXTURE_2D, m_emissiveTex, 0);
+    m_albedoTex   = makeTarget(width, height, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, GL_COLOR_ATTACHMENT2);
+    // Emissive (linear, see above)
+    m_emissiveTex = makeTarget(width, height, GL_RGBA16F, GL_RGBA, GL_FLOAT, GL_COLOR_ATTACHMENT3, GL_LINEAR);
 }
 
 void GBuffer::createDepth(int width, int height) {
@@ -4,18 +4,24 @@
 #define GL_SILENCE_DEPRECATION
 #endif
 #include <GL/glew.h>
+#include <cstddef>
 
 class GBuffer {
 public:
+    // LAYOUT_FULL:    position RGBA32F | normal RGBA16F | albedo RGBA8 | emissive RGBA16F | depth 24
+    // LAYOUT_COMPACT: normal RG16 (octahedral) | albedo RGBA8 | emissive R11G11B10F | depth 24,
+    //                 position is rebuilt from depth in the lighting pass
+    enum Layout { LAYOUT_FULL, LAYOUT_COMPACT };
+
     GBuffer();
     ~GBuffer();
 
-    void init(int width, int height);
+    void init(int width, int height, Layout layout = LAYOUT_FULL);
     void resize(int width, int height);
     void bindForWriting();
 
     // Getters for textures
-    GLuint getPositionTex() const { return m_positionTex; }
+    GLuint getPositionTex() const { return m_positionTex; }   // 0 in LAYOUT_COMPACT
     GLuint getNormalTex()   const { return m_normalTex; }
     GLuint getAlbedoTex()   const { return m_albedoTex; }
     GLuint getEmissiveTex() const { return m_emissiveTex; }
@@ -24,6 +30,12 @@ public:
     int getWidth() const { return m_width; }
     int getHeight() const { return m_height; }
 
+    Layout getLayout() const { return m_layout; }
+    bool isCompact() const { return m_layout == LAYOUT_COMPACT; }
+
+    // bytes written per pixel across all attachments (incl. depth)
+    size_t getBytesPerPixel() const;
+
 private:
     void createTextures(int width, int height);
     void createDepth(int width, int height);
@@ -38,4 +50,5 @@ private:
 
     int m_width = 0;
     int m_height = 0;
+    Layout m_layout = LAYOUT_FULL;
 };
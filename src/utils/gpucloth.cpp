@@ -0,0 +1,289 @@
+#include "gpucloth.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+// texture units for the buffer textures; unit 0 stays free for the
+// G-buffer shader's sampler2D. The step pass has particles on unit 2, the
+// draw the previous state
+const int STATE_UNIT     = 1;
+const int PARTICLES_UNIT = 2;
+const int PREV_UNIT      = 2;
+
+// clothstep.vert's passes
+const int PASS_PREDICT   = 0;
+const int PASS_CONSTRAIN = 1;
+const int PASS_FINISH    = 2;
+
+void makeBufferTexture(GLuint &buf, GLuint &tex, GLsizeiptr bytes) {
+    glGenBuffers(1, &buf);
+    glBindBuffer(GL_TEXTURE_BUFFER, buf);
+    glBufferData(GL_TEXTURE_BUFFER, bytes, nullptr, GL_DYNAMIC_COPY);
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_BUFFER, tex);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, buf);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void bindBufferTexture(int unit, GLuint tex) {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_BUFFER, tex);
+}
+}
+
+GpuCloth::~GpuCloth() {
+    destroy();
+}
+
+bool GpuCloth::init(int width, int height) {
+    destroy();
+    if (width < 2 || height < 2) return false;
+
+    try {
+        m_stepShader.createFeedback("resources/shaders/clothstep.vert", { "outPos", "outVel", "outStart" });
+    } catch (const std::runtime_error &e) {
+        std::cerr << "GPU cloth unavailable\n" << e.what() << std::endl;
+        m_stepShader.destroy();
+        return false;
+    }
+
+    m_width  = width;
+    m_height = height;
+
+    StepUniforms &u = m_uniforms;
+    u.width    = m_stepShader.uniform("width");
+    u.height   = m_stepShader.uniform("height");
+    u.pass     = m_stepShader.uniform("pass");
+    u.h        = m_stepShader.uniform("h");
+    u.sinT     = m_stepShader.uniform("sinT");
+    u.cosT     = m_stepShader.uniform("cosT");
+    u.gravity  = m_stepShader.uniform("gravity");
+    u.wind     = m_stepShader.uniform("wind");
+    u.pinT     = m_stepShader.uniform("pinT");
+    u.axis     = m_stepShader.uniform("axis");
+    u.span     = m_stepShader.uniform("span");
+    u.colour   = m_stepShader.uniform("colour");
+    u.rest     = m_stepShader.uniform("rest");
+    u.alphaTilde = m_stepShader.uniform("alphaTilde");
+    u.invH     = m_stepShader.uniform("invH");
+    u.velScale = m_stepShader.uniform("velScale");
+    u.sphereCenter = m_stepShader.uniform("sphereCenter");
+    u.sphereRadius = m_stepShader.uniform("sphereRadius");
+    u.floorY   = m_stepShader.uniform("floorY");
+    for (int i = 0; i < MAX_PINS; ++i) {
+        u.pinFrom[i] = m_stepShader.uniform("pinFrom[" + std::to_string(i) + "]");
+        u.pinTo[i]   = m_stepShader.uniform("pinTo[" + std::to_string(i) + "]");
+    }
+
+    m_stepShader.use();
+    m_stepShader.set("state", STATE_UNIT);
+    m_stepShader.set("particles", PARTICLES_UNIT);
+    glUseProgram(0);
+
+    const int count = width * height;
+    const GLsizeiptr stateBytes = GLsizeiptr(count) * STATE_TEXELS * sizeof(glm::vec4);
+    for (int i = 0; i < 2; ++i) makeBufferTexture(m_state[i], m_stateTex[i], stateBytes);
+    makeBufferTexture(m_prev, m_prevTex, stateBytes);
+    makeBufferTexture(m_particles, m_particlesTex, GLsizeiptr(count) * sizeof(glm::vec4));
+
+    // two triangles per cell, same winding as ClothMesh
+    std::vector<GLuint> indices;
+    indices.reserve((width - 1) * (height - 1) * 6);
+    for (int y = 0; y + 1 < height; ++y) {
+        for (int x = 0; x + 1 < width; ++x) {
+            GLuint i = GLuint(y * width + x);
+            GLuint right = i + 1, below = i + GLuint(width);
+            indices.insert(indices.end(), { i, right, below });
+            indices.insert(indices.end(), { right, below + 1, below });
+        }
+    }
+    m_numIndices = (int)indices.size();
+
+    glGenVertexArrays(1, &m_stepVAO);
+    glGenVertexArrays(1, &m_drawVAO);
+    glGenBuffers(1, &m_indexBuf);
+    glBindVertexArray(m_drawVAO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuf);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+    glBindVertexArray(0);
+
+    m_current = 0;
+    m_pins.clear();
+    m_time = 0.0f;
+    return true;
+}
+
+void GpuCloth::destroy() {
+    for (int i = 0; i < 2; ++i) {
+        if (m_stateTex[i]) glDeleteTextures(1, &m_stateTex[i]);
+        if (m_state[i]) glDeleteBuffers(1, &m_state[i]);
+        m_state[i] = m_stateTex[i] = 0;
+    }
+    for (GLuint *tex : { &m_prevTex, &m_particlesTex }) {
+        if (*tex) glDeleteTextures(1, tex);
+        *tex = 0;
+    }
+    for (GLuint *buf : { &m_prev, &m_particles, &m_indexBuf }) {
+        if (*buf) glDeleteBuffers(1, buf);
+        *buf = 0;
+    }
+    if (m_stepVAO) glDeleteVertexArrays(1, &m_stepVAO);
+    if (m_drawVAO) glDeleteVertexArrays(1, &m_drawVAO);
+    m_stepVAO = m_drawVAO = 0;
+    m_stepShader.destroy();
+    m_width = m_height = m_numIndices = 0;
+}
+
+void GpuCloth::load(const std::vector<glm::vec4> &state, const std::vector<glm::vec4> &particles) {
+    m_current = 0;
+    for (GLuint buf : { m_state[0], m_prev }) {
+        glBindBuffer(GL_TEXTURE_BUFFER, buf);
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, state.size() * sizeof(glm::vec4), state.data());
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, m_particles);
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, particles.size() * sizeof(glm::vec4), particles.data());
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void GpuCloth::keepPrevious() {
+    if (!isValid()) return;
+    const GLsizeiptr bytes = GLsizeiptr(m_width) * m_height * STATE_TEXELS * sizeof(glm::vec4);
+    glBindBuffer(GL_COPY_READ_BUFFER, m_state[m_current]);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_prev);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, bytes);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void GpuCloth::step(float dt) {
+    if (!isValid() || dt <= 0.0f) return;
+
+    const ClothSettings &cs = m_settings;
+    const int substeps = std::max(cs.substeps, 1);
+    const float h = dt / float(substeps);
+    const float invH2 = 1.0f / (h * h);
+    const float stretch = cs.stretchCompliance * invH2;
+    const float bend    = cs.bendCompliance * invH2;
+
+    // the constraint passes in ClothSolver::stepView() order, two colours each
+    struct Family { int axis, span; float rest, alphaTilde; };
+    const Family families[4] = {
+        { 0, 1, cs.restX, stretch }, { 1, 1, cs.restY, stretch },
+        { 0, 2, 2.0f * cs.restX, bend }, { 1, 2, 2.0f * cs.restY, bend },
+    };
+
+    // per step, as stepView() has them
+    StepUniforms &u = m_uniforms;
+    m_stepShader.use();
+    m_stepShader.set(u.width, m_width);
+    m_stepShader.set(u.height, m_height);
+    m_stepShader.set(u.h, h);
+    m_stepShader.set(u.gravity, cs.gravity);
+    m_stepShader.set(u.wind, cs.windDir * cs.windStrength);
+    m_stepShader.set(u.invH, 1.0f / h);
+    m_stepShader.set(u.velScale, 1.0f / (h * (1.0f + cs.damping * h)));
+    m_stepShader.set(u.sphereCenter, cs.sphereCenter);
+    m_stepShader.set(u.sphereRadius, cs.sphereRadius);
+    m_stepShader.set(u.floorY, cs.floorY);
+    for (int i = 0; i < (int)m_pins.size(); ++i) {
+        m_stepShader.set(u.pinFrom[i], m_pins[i].from);
+        m_stepShader.set(u.pinTo[i], m_pins[i].to);
+    }
+
+    bindBufferTexture(PARTICLES_UNIT, m_particlesTex);
+    glBindVertexArray(m_stepVAO);
+    glEnable(GL_RASTERIZER_DISCARD);
+
+    for (int s = 0; s < substeps; ++s) {
+        m_time += h;
+        m_stepShader.set(u.sinT, std::sin(cs.windFreq * m_time));
+        m_stepShader.set(u.cosT, std::cos(cs.windFreq * m_time));
+        m_stepShader.set(u.pinT, float(s + 1) / float(substeps));
+        m_stepShader.set(u.pass, PASS_PREDICT);
+        runPass();
+
+        m_stepShader.set(u.pass, PASS_CONSTRAIN);
+        for (const Family &f : families) {
+            m_stepShader.set(u.axis, f.axis);
+            m_stepShader.set(u.span, f.span);
+            m_stepShader.set(u.rest, f.rest);
+            m_stepShader.set(u.alphaTilde, f.alphaTilde);
+            for (int colour = 0; colour < 2; ++colour) {
+                m_stepShader.set(u.colour, colour);
+                runPass();
+            }
+        }
+
+        m_stepShader.set(u.pass, PASS_FINISH);
+        runPass();
+    }
+
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    glDisable(GL_RASTERIZER_DISCARD);
+    glBindVertexArray(0);
+    bindBufferTexture(STATE_UNIT, 0);
+    bindBufferTexture(PARTICLES_UNIT, 0);
+    glActiveTexture(GL_TEXTURE0);
+
+    for (Pin &pin : m_pins) pin.from = pin.to;
+}
+
+void GpuCloth::runPass() {
+    // read the live buffer, write the other
+    int next = 1 - m_current;
+    bindBufferTexture(STATE_UNIT, m_stateTex[m_current]);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, m_state[next]);
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, m_width * m_height);
+    glEndTransformFeedback();
+    m_current = next;
+}
+
+void GpuCloth::readPositions(std::vector<glm::vec3> &out) const {
+    out.clear();
+    if (!isValid()) return;
+
+    std::vector<glm::vec4> state(size_t(STATE_TEXELS) * m_width * m_height);
+    glBindBuffer(GL_TEXTURE_BUFFER, m_state[m_current]);
+    glGetBufferSubData(GL_TEXTURE_BUFFER, 0, state.size() * sizeof(glm::vec4), state.data());
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    out.reserve(size_t(m_width) * m_height);
+    for (size_t i = 0; i < state.size(); i += STATE_TEXELS) out.push_back(glm::vec3(state[i]));
+}
+
+GpuCloth::DrawUniforms GpuCloth::locate(const ShaderProgram &program) {
+    DrawUniforms u;
+    u.state     = program.uniform("state");
+    u.prevState = program.uniform("prevState");
+    u.alpha     = program.uniform("alpha");
+    u.width     = program.uniform("width");
+    u.height    = program.uniform("height");
+    return u;
+}
+
+void GpuCloth::draw(ShaderProgram &shader, const DrawUniforms &u, float alpha) const {
+    if (!isValid()) return;
+
+    bindBufferTexture(STATE_UNIT, m_stateTex[m_current]);
+    bindBufferTexture(PREV_UNIT, m_prevTex);
+    glActiveTexture(GL_TEXTURE0);
+
+    shader.set(u.state, STATE_UNIT);
+    shader.set(u.prevState, PREV_UNIT);
+    shader.set(u.alpha, glm::clamp(alpha, 0.0f, 1.0f));
+    shader.set(u.width, m_width);
+    shader.set(u.height, m_height);
+
+    glBindVertexArray(m_drawVAO);
+    glDrawElements(GL_TRIANGLES, m_numIndices, GL_UNSIGNED_INT, nullptr);
+    glBindVertexArray(0);
+
+    bindBufferTexture(STATE_UNIT, 0);
+    bindBufferTexture(PREV_UNIT, 0);
+    glActiveTexture(GL_TEXTURE0);
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#ifdef __APPLE__
+#define GL_SILENCE_DEPRECATION
+#endif
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cmath>
+#include <vector>
+
+#include "shaderprogram.h"
+#include "sim/clothgrid.h"
+
+/**
+ * GpuCloth - the ClothGrid solver on the GPU, one vertex per particle
+ *
+ * Each pass is one transform feedback draw of clothstep.vert over
+ * width * height points, rasterizer off: a vertex reads its own and its
+ * neighbours' state from a buffer texture and writes its particle into the
+ * other of two ping-pong buffers. A substep is the passes of
+ * ClothSolver::stepView() in its order: predict, the eight constraint
+ * colours (stretch rows, columns, bend rows, columns, two colours each),
+ * finish. Inside one colour every particle is in at most one constraint,
+ * so the result is the CPU's Gauss-Seidel sweep, up to float rounding.
+ * Everything is GL 4.1; nothing is read back.
+ *
+ * draw() feeds the G-buffer straight from those buffers: gbuffer_cloth.vert
+ * fetches each particle by gl_VertexID through a static index buffer,
+ * blends between the state before the last step() and the current one,
+ * and takes normals from the neighbours.
+ *
+ * Buffer texture layouts (RGBA32F):
+ *   state      3 texels per particle: position (w = 1), velocity (w = 0),
+ *              position at the start of the substep (w = 1)
+ *   particles  1 texel: invMass, sin(wind phase), cos(wind phase), pin (-1 = none)
+ */
+class GpuCloth {
+public:
+    static constexpr int MAX_PINS = 16;   // must match clothstep.vert
+
+    GpuCloth() = default;
+    ~GpuCloth();
+
+    // false (with the reason on stderr) if the step shader doesn't build
+    bool init(int width, int height);
+    void destroy();
+    bool isValid() const { return m_stepShader.isValid(); }
+
+    int getWidth() const  { return m_width; }
+    int getHeight() const { return m_height; }
+    float getTime() const { return m_time; }
+
+    // same meaning as on ClothGrid; upload() copies them from the grid
+    // (the wind phases are baked in there, later changes to them are ignored)
+    ClothSettings &settings() { return m_settings; }
+    const ClothSettings &settings() const { return m_settings; }
+    void setPinTarget(int pin, const glm::vec3 &target) {
+        if (pin >= 0 && pin < (int)m_pins.size()) m_pins[pin].to = target;
+    }
+
+    // takes over a grid of the same size: particles, pins, time, settings
+    template <int W, int H>
+    void upload(const ClothGrid<W, H> &grid);
+
+    // the state draw() blends from becomes the current one; call once per
+    // sim tick, before the tick's step() (if any)
+    void keepPrevious();
+
+    // same dt / substep split as ClothGrid::step()
+    void step(float dt);
+
+    // current positions, row-major; stalls on the GPU, for validation only
+    void readPositions(std::vector<glm::vec3> &out) const;
+
+    // handles of the uniforms draw() sets on the cloth program
+    struct DrawUniforms {
+        ShaderProgram::Uniform state = -1, prevState = -1, alpha = -1;
+        ShaderProgram::Uniform width = -1, height = -1;
+    };
+    // looks them up on program (once, after linking)
+    static DrawUniforms locate(const ShaderProgram &program);
+
+    // program built from gbuffer_cloth.vert, bound, with view / proj / colours
+    // set; alpha = 0 draws the state at the last keepPrevious(), 1 the current
+    void draw(ShaderProgram &shader, const DrawUniforms &u, float alpha) const;
+
+private:
+    struct Pin {
+        int index;            // row-major particle index
+        glm::vec3 from, to;
+    };
+
+    // texels of state per particle
+    static constexpr int STATE_TEXELS = 3;
+
+    void load(const std::vector<glm::vec4> &state, const std::vector<glm::vec4> &particles);
+    void runPass();
+
+    int m_width  = 0;
+    int m_height = 0;
+    int m_numIndices = 0;
+
+    ClothSettings m_settings;
+    std::vector<Pin> m_pins;
+    float m_time = 0.0f;
+
+    ShaderProgram m_stepShader;
+    struct StepUniforms {
+        ShaderProgram::Uniform width = -1, height = -1, pass = -1;
+        ShaderProgram::Uniform h = -1, sinT = -1, cosT = -1, gravity = -1, wind = -1;
+        ShaderProgram::Uniform pinT = -1;
+        ShaderProgram::Uniform pinFrom[MAX_PINS], pinTo[MAX_PINS];
+        ShaderProgram::Uniform axis = -1, span = -1, colour = -1, rest = -1, alphaTilde = -1;
+        ShaderProgram::Uniform invH = -1, velScale = -1;
+        ShaderProgram::Uniform sphereCenter = -1, sphereRadius = -1, floorY = -1;
+    } m_uniforms;
+
+    GLuint m_state[2]    = {0, 0};   // ping-pong, m_current is the live one
+    GLuint m_stateTex[2] = {0, 0};
+    GLuint m_prev = 0, m_prevTex = 0;
+    GLuint m_particles = 0, m_particlesTex = 0;
+    int m_current = 0;
+
+    GLuint m_stepVAO = 0;   // no attributes, the pass only needs gl_VertexID
+    GLuint m_drawVAO = 0;   // just the index buffer
+    GLuint m_indexBuf = 0;
+};
+
+template <int W, int H>
+void GpuCloth::upload(const ClothGrid<W, H> &grid) {
+    if (!isValid() || grid.getWidth() != m_width || grid.getHeight() != m_height) return;
+
+    m_settings = grid.settings();
+    m_time = grid.getTime();
+
+    std::vector<glm::vec4> state(size_t(STATE_TEXELS) * m_width * m_height);
+    std::vector<glm::vec4> particles(size_t(m_width) * m_height);
+    for (int y = 0; y < m_height; ++y) {
+        for (int x = 0; x < m_width; ++x) {
+            int i = y * m_width + x;
+            // ClothSolver::rebuildPhases()
+            float phase = m_settings.windPhaseX * x + m_settings.windPhaseY * y;
+            state[STATE_TEXELS * i]     = glm::vec4(grid.getPos(x, y), 1.0f);
+            state[STATE_TEXELS * i + 1] = glm::vec4(grid.getVel(x, y), 0.0f);
+            state[STATE_TEXELS * i + 2] = state[STATE_TEXELS * i];
+            particles[i] = glm::vec4(grid.getInvMass(x, y), std::sin(phase), std::cos(phase), -1.0f);
+        }
+    }
+
+    // grid pins index its padded rows
+    m_pins.clear();
+    for (const ClothSolver::Pin &pin : grid.getPins()) {
+        if ((int)m_pins.size() == MAX_PINS) break;
+        int i = (pin.index / grid.getStride()) * m_width + pin.index % grid.getStride();
+        particles[i].w = float(m_pins.size());
+        m_pins.push_back({ i, pin.from, pin.to });
+    }
+
+    load(state, particles);
+}
@@ -0,0 +1,56 @@
+#include "lightbuffer.h"
+
+#include <cmath>
+
+LightBuffer::~LightBuffer() {
+    destroy();
+}
+
+void LightBuffer::init() {
+    if (m_ubo) return;
+    glGenBuffers(1, &m_ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, m_ubo);
+    glBufferData(GL_UNIFORM_BUFFER, MAX_LIGHTS * sizeof(GPULight), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void LightBuffer::destroy() {
+    if (m_ubo) glDeleteBuffers(1, &m_ubo);
+    m_ubo = 0;
+}
+
+void LightBuffer::attach(const ShaderProgram &program) {
+    GLuint index = glGetUniformBlockIndex(program.getId(), "LightBlock");
+    if (index != GL_INVALID_INDEX) glUniformBlockBinding(program.getId(), index, BINDING);
+}
+
+void LightBuffer::addPoint(const glm::vec3 &pos, const glm::vec3 &color,
+                           const glm::vec3 &atten, float range) {
+    m_staging.push_back({
+        glm::vec4(pos, float(POINT)),
+        glm::vec4(color, 0.f),
+        glm::vec4(0.f),
+        glm::vec4(atten, range)
+    });
+}
+
+float LightBuffer::rangeFor(const glm::vec3 &color, const glm::vec3 &atten, float cutoff) {
+    float peak = std::max(color.r, std::max(color.g, color.b));
+    if (peak <= 0.f || cutoff <= 0.f) return 0.f;
+
+    // c d^2 + b d + (a - peak / cutoff) = 0, positive root
+    float a = atten.x, b = atten.y, c = atten.z;
+    float k = a - peak / cutoff;
+    if (k >= 0.f) return 0.f;   // never gets that bright
+    if (c <= 0.f) return b > 0.f ? -k / b : 0.f;
+    return (-b + std::sqrt(b * b - 4.f * c * k)) / (2.f * c);
+}
+
+void LightBuffer::upload() {
+    glBindBuffer(GL_UNIFORM_BUFFER, m_ubo);
+    if (!m_staging.empty()) {
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, getUniformCount() * sizeof(GPULight), m_staging.data());
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, BINDING, m_ubo);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#ifdef __APPLE__
+#define GL_SILENCE_DEPRECATION
+#endif
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <vector>
+
+#include "shaderprogram.h"
+
+/**
+ * LightBuffer - every scene light in one std140 uniform block
+ *
+ * Matches "LightBlock" in deferredLighting.frag. Lights are staged on the
+ * CPU with add() each frame and go up in a single glBufferSubData, only as
+ * many bytes as there are lights. The block itself is sized for MAX_LIGHTS
+ * (exactly the 16 KB every GL 3.3+ driver must allow); the staged list is
+ * not capped, TiledLighting takes all of it.
+ *
+ * std140: each Light is four vec4s, the scalars ride in the w components.
+ */
+class LightBuffer {
+public:
+    static constexpr int    MAX_LIGHTS = 256;
+    static constexpr GLuint BINDING    = 0;   // uniform buffer binding point
+
+    enum Type { POINT = 0, DIRECTIONAL = 1, SPOT = 2 };
+
+    struct GPULight {
+        glm::vec4 posType;       // xyz = position, w = Type
+        glm::vec4 colorAngle;    // rgb = color, w = spot angle
+        glm::vec4 dirPenumbra;   // xyz = direction, w = spot penumbra
+        glm::vec4 atten;         // xyz = constant / linear / quadratic, w = range
+    };
+    static_assert(sizeof(GPULight) == 64, "GPULight must match the std140 layout");
+
+    LightBuffer() = default;
+    ~LightBuffer();
+
+    void init();
+    void destroy();
+
+    // hook a program's LightBlock up to BINDING (once, after linking)
+    static void attach(const ShaderProgram &program);
+
+    void clear() { m_staging.clear(); }
+
+    // range = distance where the light is faded out completely
+    void addPoint(const glm::vec3 &pos, const glm::vec3 &color,
+                  const glm::vec3 &atten, float range);
+
+    // distance at which 1 / (a + b d + c d^2) * brightest channel drops
+    // to cutoff; the shader windows the falloff to zero there
+    static float rangeFor(const glm::vec3 &color, const glm::vec3 &atten, float cutoff);
+
+    // one glBufferSubData for the first MAX_LIGHTS staged lights, then binds the block
+    void upload();
+
+    int getCount() const { return (int)m_staging.size(); }
+    int getUniformCount() const { return std::min(getCount(), MAX_LIGHTS); }
+    const std::vector<GPULight> &getLights() const { return m_staging; }
+
+private:
+    GLuint m_ubo = 0;
+    std::vector<GPULight> m_staging;   // capacity kept across frames
+};
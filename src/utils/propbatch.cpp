@@ -0,0 +1,149 @@
+#include "propbatch.h"
+
+#include <algorithm>
+#include <cstddef>
+
+PropBatch::~PropBatch() {
+    destroy();
+}
+
+void PropBatch::init(GLuint meshVBO, int numVerts) {
+    m_meshVBO  = meshVBO;
+    m_numVerts = numVerts;
+    if (!m_instanceVBO) glGenBuffers(1, &m_instanceVBO);
+}
+
+void PropBatch::clear() {
+    m_pending.clear();
+    m_numVisible = 0;
+}
+
+void PropBatch::add(const glm::mat4 &model, const glm::vec3 &albedo,
+                    const glm::vec3 &emissive, GLuint textureID) {
+    glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
+    m_pending.push_back({ { model, albedo, emissive, normalMatrix }, textureID, (int)m_pending.size() });
+}
+
+void PropBatch::upload() {
+    destroyBuckets();
+
+    // stable so props keep their build order inside a bucket
+    std::stable_sort(m_pending.begin(), m_pending.end(),
+                     [](const Pending &a, const Pending &b) { return a.textureID < b.textureID; });
+
+    std::vector<Instance> instances;
+    instances.reserve(m_pending.size());
+    for (const Pending &p : m_pending) {
+        if (m_buckets.empty() || m_buckets.back().textureID != p.textureID) {
+            m_buckets.push_back({ p.textureID, 0, (int)instances.size(), 0, 0 });
+        }
+        m_buckets.back().capacity++;
+        m_buckets.back().count++;
+        instances.push_back(p.inst);
+    }
+    m_numVisible = (int)instances.size();
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(Instance), instances.data(), GL_DYNAMIC_DRAW);
+
+    // GL 4.1 has no base-instance draws, so each bucket gets a VAO whose
+    // instance attributes start at its first record
+    for (Bucket &bucket : m_buckets) {
+        glGenVertexArrays(1, &bucket.vao);
+        glBindVertexArray(bucket.vao);
+
+        glBindBuffer(GL_ARRAY_BUFFER, m_meshVBO);
+        glEnableVertexAttribArray(0); glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6*sizeof(float), (void*)0);
+        glEnableVertexAttribArray(1); glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6*sizeof(float), (void*)(3*sizeof(float)));
+
+        glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+        const size_t base = size_t(bucket.first) * sizeof(Instance);
+        for (int col = 0; col < 4; ++col) {
+            GLuint loc = 2 + col;
+            glEnableVertexAttribArray(loc);
+            glVertexAttribPointer(loc, 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                                  (void*)(base + offsetof(Instance, model) + col * sizeof(glm::vec4)));
+            glVertexAttribDivisor(loc, 1);
+        }
+        glEnableVertexAttribArray(6);
+        glVertexAttribPointer(6, 3, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)(base + offsetof(Instance, albedo)));
+        glVertexAttribDivisor(6, 1);
+        glEnableVertexAttribArray(7);
+        glVertexAttribPointer(7, 3, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)(base + offsetof(Instance, emissive)));
+        glVertexAttribDivisor(7, 1);
+        for (int col = 0; col < 3; ++col) {
+            GLuint loc = 8 + col;
+            glEnableVertexAttribArray(loc);
+            glVertexAttribPointer(loc, 3, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                                  (void*)(base + offsetof(Instance, normalMatrix) + col * sizeof(glm::vec3)));
+            glVertexAttribDivisor(loc, 1);
+        }
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void PropBatch::setVisible(const std::vector<int> &ids) {
+    m_visible.assign(m_pending.size(), 0);
+    for (int id : ids) m_visible[id] = 1;
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    // orphan: last frame's draws may still be reading the old storage
+    glBufferData(GL_ARRAY_BUFFER, m_pending.size() * sizeof(Instance), nullptr, GL_DYNAMIC_DRAW);
+
+    m_numVisible = 0;
+    for (Bucket &bucket : m_buckets) {
+        m_scratch.clear();
+        for (int i = bucket.first; i < bucket.first + bucket.capacity; ++i) {
+            if (m_visible[m_pending[i].id]) m_scratch.push_back(m_pending[i].inst);
+        }
+        bucket.count = (int)m_scratch.size();
+        m_numVisible += bucket.count;
+        if (bucket.count > 0) {
+            glBufferSubData(GL_ARRAY_BUFFER, bucket.first * sizeof(Instance),
+                            m_scratch.size() * sizeof(Instance), m_scratch.data());
+        }
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void PropBatch::showAll() {
+    m_scratch.clear();
+    for (const Pending &p : m_pending) m_scratch.push_back(p.inst);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, m_scratch.size() * sizeof(Instance), m_scratch.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    for (Bucket &bucket : m_buckets) bucket.count = bucket.capacity;
+    m_numVisible = (int)m_pending.size();
+}
+
+void PropBatch::draw(ShaderProgram &shader, ShaderProgram::Uniform useTexture) const {
+    for (const Bucket &bucket : m_buckets) {
+        if (bucket.count == 0) continue;
+        if (bucket.textureID != 0) {
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, bucket.textureID);
+            shader.set(useTexture, 1);
+        } else {
+            shader.set(useTexture, 0);
+        }
+        glBindVertexArray(bucket.vao);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, m_numVerts, bucket.count);
+    }
+    glBindVertexArray(0);
+}
+
+void PropBatch::destroyBuckets() {
+    for (Bucket &bucket : m_buckets) {
+        if (bucket.vao) glDeleteVertexArrays(1, &bucket.vao);
+    }
+    m_buckets.clear();
+}
+
+void PropBatch::destroy() {
+    destroyBuckets();
+    if (m_instanceVBO) glDeleteBuffers(1, &m_instanceVBO);
+    m_instanceVBO = 0;
+}
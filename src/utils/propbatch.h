@@ -0,0 +1,95 @@
+#pragma once
+
+#ifdef __APPLE__
+#define GL_SILENCE_DEPRECATION
+#endif
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "shaderprogram.h"
+
+/**
+ * PropBatch - static props drawn with one instanced call per texture
+ *
+ * Every prop is a copy of the same mesh (the unit cube). add() collects a
+ * per-instance record (model matrix, albedo, emissive, and the normal
+ * matrix, worked out once here rather than per vertex); upload() sorts them
+ * into buckets by texture and puts the whole lot in one instance buffer.
+ * draw() then costs one glDrawArraysInstanced per bucket.
+ *
+ * setVisible() refills the instance buffer with just the given props (ids
+ * are add() order), each bucket packed from the start of its own range, so
+ * the bucket VAOs stay valid; showAll() puts everything back.
+ *
+ * Instance attributes (see gbuffer_instanced.vert):
+ *   2..5 = model matrix columns, 6 = albedo, 7 = emissive,
+ *   8..10 = normal matrix columns
+ */
+class PropBatch {
+public:
+    struct Instance {
+        glm::mat4 model;
+        glm::vec3 albedo;
+        glm::vec3 emissive;
+        glm::mat3 normalMatrix;   // transpose(inverse(mat3(model)))
+    };
+
+    PropBatch() = default;
+    ~PropBatch();
+
+    // mesh = interleaved pos(3) + normal(3) VBO shared with the plain draws
+    void init(GLuint meshVBO, int numVerts);
+
+    void clear();
+    void add(const glm::mat4 &model, const glm::vec3 &albedo,
+             const glm::vec3 &emissive, GLuint textureID);
+
+    // (re)builds the instance buffer and buckets; call after the last add()
+    void upload();
+
+    // per frame: draw only these ids (add() order), e.g. from PropBVH::cull
+    void setVisible(const std::vector<int> &ids);
+    void showAll();
+
+    // shader = gbuffer_instanced program, already bound with view/proj set
+    // and uTexture on unit 0; useTexture = its handle for that uniform
+    void draw(ShaderProgram &shader, ShaderProgram::Uniform useTexture) const;
+
+    int getNumInstances() const { return (int)m_pending.size(); }
+    int getNumVisible() const { return m_numVisible; }
+    int getNumDrawCalls() const { return (int)m_buckets.size(); }
+
+    void destroy();
+
+private:
+    struct Pending {
+        Instance inst;
+        GLuint   textureID;
+        int      id;          // add() order
+    };
+
+    // one VAO per bucket: same mesh, instance attributes offset to its range
+    struct Bucket {
+        GLuint textureID = 0;
+        GLuint vao       = 0;
+        int    first     = 0;   // range in the sorted instances
+        int    capacity  = 0;
+        int    count     = 0;   // drawn this frame
+    };
+
+    void destroyBuckets();
+
+    GLuint m_meshVBO  = 0;
+    int    m_numVerts = 0;
+    GLuint m_instanceVBO = 0;
+
+    std::vector<Pending> m_pending;
+    std::vector<Bucket>  m_buckets;
+    int m_numVisible = 0;
+
+    // setVisible scratch
+    std::vector<uint8_t>  m_visible;
+    std::vector<Instance> m_scratch;
+};
@@ -0,0 +1,142 @@
+#include "propbvh.h"
+
+#include <algorithm>
+
+// ---------- Frustum ----------
+
+Frustum::Frustum(const glm::mat4 &m) {
+    // glm is column-major: row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+    auto row = [&m](int i) { return glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]); };
+    const glm::vec4 r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+
+    planes[0] = r3 + r0;   // left
+    planes[1] = r3 - r0;   // right
+    planes[2] = r3 + r1;   // bottom
+    planes[3] = r3 - r1;   // top
+    planes[4] = r3 + r2;   // near
+    planes[5] = r3 - r2;   // far
+
+    for (glm::vec4 &p : planes) {
+        p /= glm::length(glm::vec3(p));
+    }
+}
+
+Frustum::Result Frustum::classify(const AABB &box) const {
+    Result result = INSIDE;
+    for (const glm::vec4 &p : planes) {
+        const glm::vec3 n(p);
+        // corner furthest along the normal, and the one furthest against it
+        const glm::vec3 pos(n.x >= 0.f ? box.max.x : box.min.x,
+                            n.y >= 0.f ? box.max.y : box.min.y,
+                            n.z >= 0.f ? box.max.z : box.min.z);
+        const glm::vec3 neg(n.x >= 0.f ? box.min.x : box.max.x,
+                            n.y >= 0.f ? box.min.y : box.max.y,
+                            n.z >= 0.f ? box.min.z : box.max.z);
+        if (glm::dot(n, pos) + p.w < 0.f) return OUTSIDE;
+        if (glm::dot(n, neg) + p.w < 0.f) result = INTERSECTS;
+    }
+    return result;
+}
+
+// ---------- PropBVH ----------
+
+void PropBVH::clear() {
+    m_nodes.clear();
+    m_items.clear();
+    m_boxes.clear();
+    m_nodesTested = 0;
+}
+
+void PropBVH::build(const std::vector<AABB> &boxes) {
+    clear();
+    if (boxes.empty()) return;
+
+    m_boxes = boxes;
+    m_items.resize(boxes.size());
+    for (size_t i = 0; i < boxes.size(); ++i) m_items[i] = int(i);
+
+    m_nodes.reserve(2 * (boxes.size() / LEAF_SIZE + 1));
+    m_nodes.emplace_back();
+    buildNode(0, 0, (int)boxes.size());
+}
+
+// fills node index for items [begin, end)
+void PropBVH::buildNode(int index, int begin, int end) {
+    AABB bounds, centroids;
+    for (int i = begin; i < end; ++i) {
+        bounds.grow(m_boxes[m_items[i]]);
+        centroids.grow(m_boxes[m_items[i]].center());
+    }
+    m_nodes[index].box = bounds;
+
+    const int n = end - begin;
+    const glm::vec3 extent = centroids.max - centroids.min;
+    if (n <= LEAF_SIZE || glm::max(extent.x, glm::max(extent.y, extent.z)) <= 0.f) {
+        m_nodes[index].first = begin;
+        m_nodes[index].count = n;
+        return;
+    }
+
+    int axis = 0;
+    if (extent.y > extent[axis]) axis = 1;
+    if (extent.z > extent[axis]) axis = 2;
+
+    const int mid = begin + n / 2;
+    std::nth_element(m_items.begin() + begin, m_items.begin() + mid, m_items.begin() + end,
+                     [this, axis](int a, int b) {
+                         return m_boxes[a].center()[axis] < m_boxes[b].center()[axis];
+                     });
+
+    // children go in as a pair, so right = left + 1
+    const int left = (int)m_nodes.size();
+    m_nodes.emplace_back();
+    m_nodes.emplace_back();
+    m_nodes[index].first = left;
+    m_nodes[index].count = 0;
+
+    buildNode(left, begin, mid);
+    buildNode(left + 1, mid, end);
+}
+
+void PropBVH::addSubtree(int node, std::vector<int> &visible) const {
+    const Node &n = m_nodes[node];
+    if (n.count > 0) {
+        visible.insert(visible.end(), m_items.begin() + n.first, m_items.begin() + n.first + n.count);
+        return;
+    }
+    addSubtree(n.first, visible);
+    addSubtree(n.first + 1, visible);
+}
+
+void PropBVH::cull(const Frustum &frustum, std::vector<int> &visible) const {
+    visible.clear();
+    m_nodesTested = 0;
+    if (m_nodes.empty()) return;
+
+    // median splits keep the depth near log2(n / LEAF_SIZE)
+    int stack[64];
+    int top = 0;
+    stack[top++] = 0;
+
+    while (top > 0) {
+        const Node &node = m_nodes[stack[--top]];
+
+        ++m_nodesTested;
+        const Frustum::Result r = frustum.classify(node.box);
+        if (r == Frustum::OUTSIDE) continue;
+
+        if (r == Frustum::INSIDE) {
+            addSubtree(int(&node - m_nodes.data()), visible);
+        } else if (node.count > 0) {
+            // leaf straddling a plane: test its items on their own
+            for (int i = node.first; i < node.first + node.count; ++i) {
+                if (frustum.classify(m_boxes[m_items[i]]) != Frustum::OUTSIDE) {
+                    visible.push_back(m_items[i]);
+                }
+            }
+        } else {
+            stack[top++] = node.first;
+            stack[top++] = node.first + 1;
+        }
+    }
+}
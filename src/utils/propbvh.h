@@ -0,0 +1,70 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+struct AABB {
+    glm::vec3 min = glm::vec3( 1e30f);
+    glm::vec3 max = glm::vec3(-1e30f);
+
+    void grow(const AABB &b) { min = glm::min(min, b.min); max = glm::max(max, b.max); }
+    void grow(const glm::vec3 &p) { min = glm::min(min, p); max = glm::max(max, p); }
+    glm::vec3 center() const { return (min + max) * 0.5f; }
+};
+
+/**
+ * Frustum - the six planes of a view-projection matrix (Gribb / Hartmann),
+ * normals pointing inwards, normalized so distances are in world units
+ */
+struct Frustum {
+    enum Result { OUTSIDE, INTERSECTS, INSIDE };
+
+    glm::vec4 planes[6];   // left, right, bottom, top, near, far
+
+    explicit Frustum(const glm::mat4 &viewProj);
+
+    Result classify(const AABB &box) const;
+};
+
+/**
+ * PropBVH - static bounding volume hierarchy over the arena props
+ *
+ * Built once from the prop boxes (median split on the longest centroid
+ * axis, up to LEAF_SIZE items per leaf). cull() walks it against a frustum:
+ * a node outside is skipped with its whole subtree, a node fully inside
+ * takes its whole subtree without further plane tests.
+ *
+ * Item ids are the indices into the boxes passed to build().
+ */
+class PropBVH {
+public:
+    static constexpr int LEAF_SIZE = 4;
+
+    void build(const std::vector<AABB> &boxes);
+    void clear();
+
+    // visible item ids, appended in no particular order (visible is cleared first)
+    void cull(const Frustum &frustum, std::vector<int> &visible) const;
+
+    int getNumItems() const { return (int)m_items.size(); }
+    int getNumNodes() const { return (int)m_nodes.size(); }
+
+    // nodes classified against the frustum by the last cull()
+    int getNodesTested() const { return m_nodesTested; }
+
+private:
+    struct Node {
+        AABB box;
+        int  first = 0;   // leaf: into m_items; inner: left child (right = first + 1)
+        int  count = 0;   // > 0 = leaf
+    };
+
+    void buildNode(int index, int begin, int end);
+    void addSubtree(int node, std::vector<int> &visible) const;
+
+    std::vector<Node> m_nodes;
+    std::vector<int>  m_items;   // item ids, leaves own contiguous ranges
+    std::vector<AABB> m_boxes;   // by item id
+
+    mutable int m_nodesTested = 0;
+};
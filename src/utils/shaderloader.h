@@ -8,6 +8,7 @@
 #include <QFile>
 #include <QTextStream>
 #include <iostream>
+#include <vector>
 
 class ShaderLoader{
 public:
@@ -44,6 +45,65 @@ public:
         return programID;
     }
 
+    // single compute stage (GL 4.3 / ARB_compute_shader)
+    static GLuint createComputeProgram(const char * compute_file_path){
+        GLuint computeShaderID = createShader(GL_COMPUTE_SHADER, compute_file_path);
+
+        GLuint programID = glCreateProgram();
+        glAttachShader(programID, computeShaderID);
+        glLinkProgram(programID);
+
+        GLint status;
+        glGetProgramiv(programID, GL_LINK_STATUS, &status);
+
+        if (status == GL_FALSE) {
+            GLint length;
+            glGetProgramiv(programID, GL_INFO_LOG_LENGTH, &length);
+
+            std::string log(length, '\0');
+            glGetProgramInfoLog(programID, length, nullptr, &log[0]);
+
+            glDeleteProgram(programID);
+            glDeleteShader(computeShaderID);
+            throw std::runtime_error(log);
+        }
+
+        glDeleteShader(computeShaderID);
+
+        return programID;
+    }
+
+    // vertex stage only, its outputs captured by transform feedback
+    // (interleaved, in the order given) instead of rasterized
+    static GLuint createFeedbackProgram(const char * vertex_file_path,
+                                        const std::vector<const char *> &varyings){
+        GLuint vertexShaderID = createShader(GL_VERTEX_SHADER, vertex_file_path);
+
+        GLuint programID = glCreateProgram();
+        glAttachShader(programID, vertexShaderID);
+        glTransformFeedbackVaryings(programID, (GLsizei)varyings.size(), varyings.data(), GL_INTERLEAVED_ATTRIBS);
+        glLinkProgram(programID);
+
+        GLint status;
+        glGetProgramiv(programID, GL_LINK_STATUS, &status);
+
+        if (status == GL_FALSE) {
+            GLint length;
+            glGetProgramiv(programID, GL_INFO_LOG_LENGTH, &length);
+
+            std::string log(length, '\0');
+            glGetProgramInfoLog(programID, length, nullptr, &log[0]);
+
+            glDeleteProgram(programID);
+            glDeleteShader(vertexShaderID);
+            throw std::runtime_error(log);
+        }
+
+        glDeleteShader(vertexShaderID);
+
+        return programID;
+    }
+
 private:
     static GLuint createShader(GLenum shaderType, const char *filepath){
         GLuint shaderID = glCreateShader(shaderType);
@@ -0,0 +1,115 @@
+#include "shaderprogram.h"
+#include "shaderloader.h"
+
+#include <algorithm>
+#include <cstring>
+
+void ShaderProgram::create(const char *vertexPath, const char *fragmentPath) {
+    destroy();
+    m_id = ShaderLoader::createShaderProgram(vertexPath, fragmentPath);
+    reflect();
+}
+
+void ShaderProgram::createCompute(const char *computePath) {
+    destroy();
+    m_id = ShaderLoader::createComputeProgram(computePath);
+    reflect();
+}
+
+void ShaderProgram::createFeedback(const char *vertexPath, const std::vector<const char *> &varyings) {
+    destroy();
+    m_id = ShaderLoader::createFeedbackProgram(vertexPath, varyings);
+    reflect();
+}
+
+void ShaderProgram::destroy() {
+    if (m_id) glDeleteProgram(m_id);
+    m_id = 0;
+    m_uniforms.clear();
+    m_byName.clear();
+}
+
+void ShaderProgram::reflect() {
+    GLint count = 0, maxLen = 0;
+    glGetProgramiv(m_id, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(m_id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLen);
+
+    std::vector<char> buf(std::max(maxLen, 1));
+    for (GLint i = 0; i < count; ++i) {
+        GLint size = 0;
+        GLenum type = 0;
+        GLsizei len = 0;
+        glGetActiveUniform(m_id, GLuint(i), GLsizei(buf.size()), &len, &size, &type, buf.data());
+        std::string name(buf.data(), len);
+
+        // uniform blocks members report -1; they are not set through here
+        if (glGetUniformLocation(m_id, name.c_str()) < 0) continue;
+
+        // arrays of basic types come back once as "name[0]" with size > 1;
+        // element locations are not guaranteed consecutive, so ask for each
+        std::string base = name;
+        bool isArray = name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0;
+        if (isArray) base = name.substr(0, name.size() - 3);
+
+        for (GLint k = 0; k < (isArray ? size : 1); ++k) {
+            std::string element = isArray ? base + "[" + std::to_string(k) + "]" : name;
+            Entry e;
+            e.location = glGetUniformLocation(m_id, element.c_str());
+            e.type     = type;
+            if (e.location < 0) continue;
+
+            Uniform handle = (Uniform)m_uniforms.size();
+            m_uniforms.push_back(e);
+            m_byName[element] = handle;
+            if (isArray && k == 0) m_byName[base] = handle;
+        }
+    }
+}
+
+ShaderProgram::Uniform ShaderProgram::uniform(const std::string &name) const {
+    auto it = m_byName.find(name);
+    return it == m_byName.end() ? -1 : it->second;
+}
+
+bool ShaderProgram::changed(Entry &e, const void *data, size_t bytes) {
+    if (e.written && std::memcmp(e.cache, data, bytes) == 0) return false;
+    std::memcpy(e.cache, data, bytes);
+    e.written = true;
+    return true;
+}
+
+void ShaderProgram::set(Uniform u, int v) {
+    if (u < 0) return;
+    Entry &e = m_uniforms[u];
+    if (changed(e, &v, sizeof(v))) glUniform1i(e.location, v);
+}
+
+void ShaderProgram::set(Uniform u, float v) {
+    if (u < 0) return;
+    Entry &e = m_uniforms[u];
+    if (changed(e, &v, sizeof(v))) glUniform1f(e.location, v);
+}
+
+void ShaderProgram::set(Uniform u, const glm::vec2 &v) {
+    if (u < 0) return;
+    Entry &e = m_uniforms[u];
+    if (changed(e, &v[0], sizeof(v))) glUniform2fv(e.location, 1, &v[0]);
+}
+
+void ShaderProgram::set(Uniform u, const glm::vec3 &v) {
+    if (u < 0) return;
+    Entry &e = m_uniforms[u];
+    if (changed(e, &v[0], sizeof(v))) glUniform3fv(e.location, 1, &v[0]);
+}
+
+void ShaderProgram::set(Uniform u, const glm::vec4 &v) {
+    if (u < 0) return;
+    Entry &e = m_uniforms[u];
+    if (changed(e, &v[0], sizeof(v))) glUniform4fv(e.location, 1, &v[0]);
+}
+
+void ShaderProgram::set(Uniform u, const glm::mat4 &v) {
+    if (u < 0) return;
+    Entry &e = m_uniforms[u];
+    if (changed(e, &v[0][0], sizeof(v))) glUniformMatrix4fv(e.location, 1, GL_FALSE, &v[0][0]);
+}
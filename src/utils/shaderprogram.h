@@ -0,0 +1,75 @@
+#pragma once
+
+#ifdef __APPLE__
+#define GL_SILENCE_DEPRECATION
+#endif
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * ShaderProgram - linked program plus its active uniforms
+ *
+ * create() links through ShaderLoader, then asks GL for every active
+ * uniform once (array elements get their own entry, "lights[3].pos").
+ * uniform(name) turns a name into a handle; keep handles around for
+ * per-draw uniforms and setting them is an index, not a string query.
+ *
+ * Each entry remembers the last value uploaded; set() skips the glUniform
+ * call when the value has not changed. Every write must go through this
+ * class for that to hold. Setters act on the currently bound program, so
+ * call use() first.
+ */
+class ShaderProgram {
+public:
+    using Uniform = int;   // index into the reflected table, -1 = not active
+
+    ShaderProgram() = default;
+    ~ShaderProgram() = default;   // GL objects are released in destroy()
+
+    // throws std::runtime_error like ShaderLoader on compile/link errors
+    void create(const char *vertexPath, const char *fragmentPath);
+    void createCompute(const char *computePath);
+    // vertex-only program whose outputs go to transform feedback
+    void createFeedback(const char *vertexPath, const std::vector<const char *> &varyings);
+    void destroy();
+
+    void use() const { glUseProgram(m_id); }
+    GLuint getId() const { return m_id; }
+    bool isValid() const { return m_id != 0; }
+
+    // "name", "name[0]" and "arr[i].field" forms; -1 if not active
+    Uniform uniform(const std::string &name) const;
+
+    void set(Uniform u, int v);
+    void set(Uniform u, float v);
+    void set(Uniform u, const glm::vec2 &v);
+    void set(Uniform u, const glm::vec3 &v);
+    void set(Uniform u, const glm::vec4 &v);
+    void set(Uniform u, const glm::mat4 &v);
+
+    // one-off uniforms: still no GL query, just a hash lookup
+    template <typename T>
+    void set(const std::string &name, const T &v) { set(uniform(name), v); }
+
+    int getNumUniforms() const { return (int)m_uniforms.size(); }
+
+private:
+    struct Entry {
+        GLint  location = -1;
+        GLenum type     = 0;
+        bool   written  = false;   // cache holds the live value
+        float  cache[16] = {};      // big enough for a mat4
+    };
+
+    // true if the value differs from the cache (and stores it)
+    bool changed(Entry &e, const void *data, size_t bytes);
+
+    void reflect();
+
+    GLuint m_id = 0;
+    std::vector<Entry> m_uniforms;
+    std::unordered_map<std::string, Uniform> m_byName;
+};
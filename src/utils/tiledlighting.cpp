@@ -0,0 +1,240 @@
+#include "tiledlighting.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+TiledLighting::~TiledLighting() {
+    destroy();
+}
+
+static void makeBufferTexture(GLuint &buf, GLuint &tex, GLenum format) {
+    glGenBuffers(1, &buf);
+    glBindBuffer(GL_TEXTURE_BUFFER, buf);
+    glBufferData(GL_TEXTURE_BUFFER, 16, nullptr, GL_STREAM_DRAW);
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_BUFFER, tex);
+    glTexBuffer(GL_TEXTURE_BUFFER, format, buf);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void TiledLighting::init(int width, int height) {
+    destroy();
+
+    makeBufferTexture(m_lightBuf, m_lightTex, GL_RGBA32F);
+    makeBufferTexture(m_gridBuf,  m_gridTex,  GL_RG32UI);
+    makeBufferTexture(m_indexBuf, m_indexTex, GL_R32UI);
+
+    // compute needs a 4.3 context; macOS stops at 4.1, so fall back quietly
+    if (GLEW_VERSION_4_3) {
+        try {
+            m_cullShader.createCompute("resources/shaders/tiledcull.comp");
+
+            // the image / sampler units never change
+            m_cullShader.use();
+            m_cullShader.set("depthTex", 0);
+            m_cullShader.set("lightData", 1);
+            m_cullShader.set("tileGrid", 0);
+            m_cullShader.set("tileIndices", 1);
+            glUseProgram(0);
+
+            CullUniforms &u = m_cullUniforms;
+            u.numLights  = m_cullShader.uniform("numLights");
+            u.screenSize = m_cullShader.uniform("screenSize");
+            u.view       = m_cullShader.uniform("view");
+            u.proj       = m_cullShader.uniform("proj");
+            u.invProj    = m_cullShader.uniform("invProj");
+        } catch (const std::runtime_error &e) {
+            std::cerr << "tiled light culling: compute path unavailable, binning on the CPU\n"
+                      << e.what() << std::endl;
+            m_cullShader.destroy();
+        }
+    }
+    m_useCompute = hasCompute();
+
+    m_width = m_height = 0;
+    resize(width, height);
+}
+
+void TiledLighting::resize(int width, int height) {
+    if (width <= 0 || height <= 0) return;
+    if (width == m_width && height == m_height) return;
+
+    m_width  = width;
+    m_height = height;
+    m_tilesX = (width  + TILE_SIZE - 1) / TILE_SIZE;
+    m_tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+    m_grid.assign(size_t(m_tilesX) * m_tilesY * 2, 0);
+    if (m_useCompute) allocComputeBuffers();
+}
+
+void TiledLighting::setUseCompute(bool use) {
+    use = use && hasCompute();
+    if (use && !m_useCompute && m_width > 0) allocComputeBuffers();
+    m_useCompute = use;
+}
+
+void TiledLighting::allocComputeBuffers() {
+    const size_t numTiles = size_t(m_tilesX) * m_tilesY;
+    glBindBuffer(GL_TEXTURE_BUFFER, m_gridBuf);
+    glBufferData(GL_TEXTURE_BUFFER, numTiles * 2 * sizeof(uint32_t), nullptr, GL_DYNAMIC_COPY);
+    glBindBuffer(GL_TEXTURE_BUFFER, m_indexBuf);
+    glBufferData(GL_TEXTURE_BUFFER, numTiles * MAX_LIGHTS_PER_TILE * sizeof(uint32_t), nullptr, GL_DYNAMIC_COPY);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void TiledLighting::destroy() {
+    m_cullShader.destroy();
+    GLuint bufs[] = { m_lightBuf, m_gridBuf, m_indexBuf };
+    GLuint texs[] = { m_lightTex, m_gridTex, m_indexTex };
+    if (m_lightBuf) glDeleteBuffers(3, bufs);
+    if (m_lightTex) glDeleteTextures(3, texs);
+    m_lightBuf = m_gridBuf = m_indexBuf = 0;
+    m_lightTex = m_gridTex = m_indexTex = 0;
+    m_useCompute = false;
+    m_width = m_height = 0;
+}
+
+void TiledLighting::update(const std::vector<LightBuffer::GPULight> &lights,
+                           const glm::mat4 &view, const glm::mat4 &proj, GLuint depthTex) {
+    // lights: orphan and refill, the buffer grows with the light count
+    glBindBuffer(GL_TEXTURE_BUFFER, m_lightBuf);
+    glBufferData(GL_TEXTURE_BUFFER, std::max<size_t>(lights.size(), 1) * sizeof(LightBuffer::GPULight),
+                 lights.empty() ? nullptr : lights.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    if (m_useCompute) cullOnGpu((int)lights.size(), view, proj, depthTex);
+    else              binOnCpu(lights, view, proj);
+}
+
+bool TiledLighting::tileRect(const glm::vec3 &c, float r, const glm::mat4 &proj,
+                             int &x0, int &y0, int &x1, int &y1) const {
+    // camera looks down -z; fully behind the near plane -> nothing to light
+    const float nearZ = proj[3][2] / (1.f - proj[2][2]);   // = -near
+    if (c.z - r > nearZ) return false;
+
+    glm::vec2 lo(1.f), hi(-1.f);
+    if (c.z + r > nearZ) {
+        // straddles the near plane: projection is unbounded, take the screen
+        lo = glm::vec2(-1.f);
+        hi = glm::vec2(1.f);
+    } else {
+        // the sphere's view-space box is entirely in front, project its corners
+        for (int i = 0; i < 8; ++i) {
+            glm::vec3 p = c + glm::vec3((i & 1) ? r : -r, (i & 2) ? r : -r, (i & 4) ? r : -r);
+            glm::vec4 clip = proj * glm::vec4(p, 1.f);
+            glm::vec2 ndc = glm::vec2(clip) / clip.w;
+            lo = glm::min(lo, ndc);
+            hi = glm::max(hi, ndc);
+        }
+        if (hi.x < -1.f || hi.y < -1.f || lo.x > 1.f || lo.y > 1.f) return false;
+        lo = glm::max(lo, glm::vec2(-1.f));
+        hi = glm::min(hi, glm::vec2(1.f));
+    }
+
+    // NDC -> pixels (bottom-left origin like gl_FragCoord) -> tiles
+    x0 = std::clamp(int((lo.x * 0.5f + 0.5f) * m_width)  / TILE_SIZE, 0, m_tilesX - 1);
+    x1 = std::clamp(int((hi.x * 0.5f + 0.5f) * m_width)  / TILE_SIZE, 0, m_tilesX - 1);
+    y0 = std::clamp(int((lo.y * 0.5f + 0.5f) * m_height) / TILE_SIZE, 0, m_tilesY - 1);
+    y1 = std::clamp(int((hi.y * 0.5f + 0.5f) * m_height) / TILE_SIZE, 0, m_tilesY - 1);
+    return true;
+}
+
+void TiledLighting::binOnCpu(const std::vector<LightBuffer::GPULight> &lights,
+                             const glm::mat4 &view, const glm::mat4 &proj) {
+    const size_t numTiles = size_t(m_tilesX) * m_tilesY;
+    std::fill(m_grid.begin(), m_grid.end(), 0u);
+
+    // pass 1: tile rect per light, count per tile
+    m_rects.resize(lights.size());
+    for (size_t i = 0; i < lights.size(); ++i) {
+        const LightBuffer::GPULight &l = lights[i];
+        glm::vec3 c = glm::vec3(view * glm::vec4(glm::vec3(l.posType), 1.f));
+        int x0, y0, x1, y1;
+        if (l.atten.w <= 0.f || !tileRect(c, l.atten.w, proj, x0, y0, x1, y1)) {
+            m_rects[i] = glm::ivec4(1, 0, 0, 0);   // empty
+            continue;
+        }
+        m_rects[i] = glm::ivec4(x0, y0, x1, y1);
+        for (int y = y0; y <= y1; ++y)
+            for (int x = x0; x <= x1; ++x)
+                m_grid[2 * (size_t(y) * m_tilesX + x) + 1]++;
+    }
+
+    // pass 2: offsets by prefix sum, then fill (count doubles as a cursor)
+    uint32_t total = 0;
+    for (size_t t = 0; t < numTiles; ++t) {
+        m_grid[2 * t] = total;
+        total += m_grid[2 * t + 1];
+        m_grid[2 * t + 1] = 0;
+    }
+    m_indices.resize(total);
+    for (size_t i = 0; i < lights.size(); ++i) {
+        const glm::ivec4 &r = m_rects[i];
+        for (int y = r.y; y <= r.w; ++y)
+            for (int x = r.x; x <= r.z; ++x) {
+                uint32_t *cell = &m_grid[2 * (size_t(y) * m_tilesX + x)];
+                m_indices[cell[0] + cell[1]++] = uint32_t(i);
+            }
+    }
+
+    glBindBuffer(GL_TEXTURE_BUFFER, m_gridBuf);
+    glBufferData(GL_TEXTURE_BUFFER, m_grid.size() * sizeof(uint32_t), m_grid.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, m_indexBuf);
+    glBufferData(GL_TEXTURE_BUFFER, std::max<size_t>(m_indices.size(), 1) * sizeof(uint32_t),
+                 m_indices.empty() ? nullptr : m_indices.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void TiledLighting::cullOnGpu(int numLights, const glm::mat4 &view, const glm::mat4 &proj, GLuint depthTex) {
+    m_cullShader.use();
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, depthTex);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_BUFFER, m_lightTex);
+    glBindImageTexture(0, m_gridTex,  0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RG32UI);
+    glBindImageTexture(1, m_indexTex, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32UI);
+
+    const CullUniforms &u = m_cullUniforms;
+    m_cullShader.set(u.numLights, numLights);
+    m_cullShader.set(u.screenSize, glm::vec2(m_width, m_height));
+    m_cullShader.set(u.view, view);
+    m_cullShader.set(u.proj, proj);
+    m_cullShader.set(u.invProj, glm::inverse(proj));
+
+    glDispatchCompute(GLuint(m_tilesX), GLuint(m_tilesY), 1);
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glUseProgram(0);
+}
+
+TiledLighting::BindUniforms TiledLighting::locate(const ShaderProgram &program) {
+    BindUniforms u;
+    u.lightData   = program.uniform("lightData");
+    u.tileGrid    = program.uniform("tileGrid");
+    u.tileIndices = program.uniform("tileIndices");
+    u.tileSize    = program.uniform("tileSize");
+    u.numTilesX   = program.uniform("numTilesX");
+    return u;
+}
+
+void TiledLighting::bind(ShaderProgram &shader, const BindUniforms &u, int firstUnit) const {
+    glActiveTexture(GL_TEXTURE0 + firstUnit);
+    glBindTexture(GL_TEXTURE_BUFFER, m_lightTex);
+    glActiveTexture(GL_TEXTURE0 + firstUnit + 1);
+    glBindTexture(GL_TEXTURE_BUFFER, m_gridTex);
+    glActiveTexture(GL_TEXTURE0 + firstUnit + 2);
+    glBindTexture(GL_TEXTURE_BUFFER, m_indexTex);
+    glActiveTexture(GL_TEXTURE0);
+
+    shader.set(u.lightData, firstUnit);
+    shader.set(u.tileGrid, firstUnit + 1);
+    shader.set(u.tileIndices, firstUnit + 2);
+    shader.set(u.tileSize, TILE_SIZE);
+    shader.set(u.numTilesX, m_tilesX);
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#ifdef __APPLE__
+#define GL_SILENCE_DEPRECATION
+#endif
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "lightbuffer.h"
+#include "shaderprogram.h"
+
+/**
+ * TiledLighting - per screen tile light lists for the deferred pass
+ *
+ * The screen is cut into TILE_SIZE x TILE_SIZE pixel tiles. Every frame
+ * each tile gets the list of lights whose range sphere can reach it, and
+ * deferredLighting.frag only loops over its own tile's list, so the cost
+ * per pixel follows the local light density instead of the total count.
+ *
+ * Two ways to build the lists, same output format:
+ *  - compute (GL 4.3): one work group per tile reads the G-buffer depth,
+ *    takes the tile's min / max view depth and tests every light against
+ *    the tile's sub-frustum
+ *  - CPU (GL 4.1, macOS): each light's sphere is projected to a screen
+ *    rectangle and binned with a counting sort. No depth bounds, since that
+ *    would mean reading the depth buffer back
+ *
+ * GPU side everything is a texture buffer:
+ *   lightData   RGBA32F, 4 texels per light (LightBuffer::GPULight)
+ *   tileGrid    RG32UI, per tile { first index, count }
+ *   tileIndices R32UI, light indices
+ */
+class TiledLighting {
+public:
+    static constexpr int TILE_SIZE           = 16;    // must match tiledcull.comp
+    static constexpr int MAX_LIGHTS_PER_TILE = 512;   // compute path slot per tile
+
+    TiledLighting() = default;
+    ~TiledLighting();
+
+    // tries the compute path when the context has it, else CPU binning
+    void init(int width, int height);
+    void resize(int width, int height);
+    void destroy();
+
+    bool hasCompute() const { return m_cullShader.isValid(); }
+    void setUseCompute(bool use);
+    bool isUsingCompute() const { return m_useCompute; }
+
+    // depthTex = G-buffer depth (compute path only)
+    void update(const std::vector<LightBuffer::GPULight> &lights,
+                const glm::mat4 &view, const glm::mat4 &proj, GLuint depthTex);
+
+    // handles of the uniforms bind() sets on a lighting program
+    struct BindUniforms {
+        ShaderProgram::Uniform lightData = -1, tileGrid = -1, tileIndices = -1;
+        ShaderProgram::Uniform tileSize = -1, numTilesX = -1;
+    };
+    // looks them up on program (once, after linking)
+    static BindUniforms locate(const ShaderProgram &program);
+
+    // binds the three buffers to texture units firstUnit.. and sets the
+    // sampler / tile uniforms on shader (which must be bound)
+    void bind(ShaderProgram &shader, const BindUniforms &u, int firstUnit) const;
+
+    int getNumTilesX() const { return m_tilesX; }
+    int getNumTilesY() const { return m_tilesY; }
+
+    // CPU path: total entries in all tile lists last frame
+    size_t getNumEntries() const { return m_indices.size(); }
+
+private:
+    void binOnCpu(const std::vector<LightBuffer::GPULight> &lights,
+                  const glm::mat4 &view, const glm::mat4 &proj);
+    void cullOnGpu(int numLights, const glm::mat4 &view, const glm::mat4 &proj, GLuint depthTex);
+
+    // the compute path writes fixed slots per tile; CPU binning re-specifies
+    // the same buffers at its own size, so this runs on every switch back
+    void allocComputeBuffers();
+
+    // screen rect of the tiles a sphere can touch; false if off screen
+    bool tileRect(const glm::vec3 &viewCenter, float radius, const glm::mat4 &proj,
+                  int &x0, int &y0, int &x1, int &y1) const;
+
+    int m_width  = 0;
+    int m_height = 0;
+    int m_tilesX = 0;
+    int m_tilesY = 0;
+
+    bool m_useCompute = false;
+    ShaderProgram m_cullShader;
+    struct CullUniforms {
+        ShaderProgram::Uniform numLights = -1, screenSize = -1;
+        ShaderProgram::Uniform view = -1, proj = -1, invProj = -1;
+    } m_cullUniforms;
+
+    GLuint m_lightBuf = 0, m_lightTex = 0;
+    GLuint m_gridBuf  = 0, m_gridTex  = 0;
+    GLuint m_indexBuf = 0, m_indexTex = 0;
+
+    // CPU binning scratch, kept between frames
+    std::vector<uint32_t> m_grid;      // 2 per tile
+    std::vector<uint32_t> m_indices;
+    std::vector<glm::ivec4> m_rects;   // per light tile rect, x1 < x0 = skipped
+};